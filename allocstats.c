@@ -0,0 +1,14 @@
+/* allocstats.c: Counting the memory allocations of the program.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	"allocstats.h"
+
+allocinfo allocstats;
+
+void alloc_mark(void)
+{
+    allocstats.mark = allocstats.live;
+}
@@ -0,0 +1,33 @@
+/* allocstats.h: Counting the memory allocations of the program.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_allocstats_h_
+#define	_allocstats_h_
+
+/* The allocations made so far by this process. They are only counted
+ * in the tws2json-allocstats build, which links allocwrap.c with
+ * --wrap (see the Makefile) so that calls to malloc(), calloc(),
+ * realloc() and free() from the program and from bstrlib go through
+ * it; memory allocated inside the C library, such as stdio buffers,
+ * is not counted. In other builds everything stays zero.
+ */
+typedef struct allocinfo {
+    int			counting;	/* nonzero if allocwrap.c is in */
+    unsigned long	allocs;		/* calls that allocated memory */
+    unsigned long	frees;		/* calls that released memory */
+    unsigned long	bytes;		/* bytes allocated, in total */
+    long		live;		/* bytes allocated and not freed */
+    long		peak;		/* the highest value of live */
+    long		mark;		/* the same since alloc_mark() */
+} allocinfo;
+
+extern allocinfo allocstats;
+
+/* Start a new high-water mark at the current number of live bytes.
+ */
+extern void alloc_mark(void);
+
+#endif
@@ -0,0 +1,92 @@
+/* allocwrap.c: Wrappers around the allocator that count allocations.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdlib.h>
+#include	<malloc.h>
+#include	"allocstats.h"
+
+/* The real functions, as renamed by the linker's --wrap option.
+ */
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t count, size_t size);
+extern void *__real_realloc(void *p, size_t size);
+extern void __real_free(void *p);
+
+/* Add a block to the counters. The size is that of the block that
+ * was actually handed out, so that free() can take back exactly as
+ * much as was added.
+ */
+static void *added(void *p)
+{
+    long	size;
+
+    if (p) {
+	size = malloc_usable_size(p);
+	++allocstats.allocs;
+	allocstats.bytes += size;
+	allocstats.live += size;
+	if (allocstats.live > allocstats.peak)
+	    allocstats.peak = allocstats.live;
+	if (allocstats.live > allocstats.mark)
+	    allocstats.mark = allocstats.live;
+    }
+    return p;
+}
+
+static void removed(void *p)
+{
+    if (p) {
+	++allocstats.frees;
+	allocstats.live -= malloc_usable_size(p);
+    }
+}
+
+/* Mark the counters as live before main() runs.
+ */
+__attribute__((constructor))
+static void startcounting(void)
+{
+    allocstats.counting = 1;
+}
+
+/* The wrappers must stay visible to the linker under -fwhole-program.
+ */
+#define	WRAPPER	__attribute__((used, externally_visible))
+
+WRAPPER void *__wrap_malloc(size_t size)
+{
+    return added(__real_malloc(size));
+}
+
+WRAPPER void *__wrap_calloc(size_t count, size_t size)
+{
+    return added(__real_calloc(count, size));
+}
+
+/* A realloc() that moves or resizes a block counts as a free of the
+ * old block and an allocation of the new one. realloc(p, 0) frees p.
+ */
+WRAPPER void *__wrap_realloc(void *p, size_t size)
+{
+    void       *q;
+    long	oldsize;
+
+    oldsize = p ? (long)malloc_usable_size(p) : 0;
+    q = __real_realloc(p, size);
+    if (!q && size)
+	return NULL;
+    if (p) {
+	++allocstats.frees;
+	allocstats.live -= oldsize;
+    }
+    return q ? added(q) : NULL;
+}
+
+WRAPPER void __wrap_free(void *p)
+{
+    removed(p);
+    __real_free(p);
+}
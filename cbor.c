@@ -0,0 +1,81 @@
+/* cbor.c: A minimal CBOR (RFC 8949) encoder.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	"cbor.h"
+
+/* The major types used here.
+ */
+#define	CBOR_UINT	0
+#define	CBOR_TEXT	3
+#define	CBOR_ARRAY	4
+#define	CBOR_MAP	5
+
+/* The additional-information value for indefinite-length items, and
+ * the "break" stop code which ends them.
+ */
+#define	CBOR_INDEFINITE	31
+#define	CBOR_BREAK	0xFF
+
+/* Write the initial byte of an item, followed by its argument in the
+ * smallest form that will hold it (big-endian, as CBOR requires).
+ */
+static void putheader(FILE *fp, int major, unsigned long long val)
+{
+    int	n;
+
+    major <<= 5;
+    if (val < 24) {
+	fputc(major | (int)val, fp);
+	return;
+    } else if (val <= 0xFF) {
+	fputc(major | 24, fp);
+	n = 1;
+    } else if (val <= 0xFFFF) {
+	fputc(major | 25, fp);
+	n = 2;
+    } else if (val <= 0xFFFFFFFFULL) {
+	fputc(major | 26, fp);
+	n = 4;
+    } else {
+	fputc(major | 27, fp);
+	n = 8;
+    }
+    while (n--)
+	fputc((int)((val >> (n * 8)) & 0xFF), fp);
+}
+
+void cbor_putuint(FILE *fp, unsigned long long val)
+{
+    putheader(fp, CBOR_UINT, val);
+}
+
+void cbor_puttext(FILE *fp, char const *str, unsigned long len)
+{
+    putheader(fp, CBOR_TEXT, len);
+    fwrite(str, 1, len, fp);
+}
+
+void cbor_putcstr(FILE *fp, char const *str)
+{
+    cbor_puttext(fp, str, strlen(str));
+}
+
+void cbor_putmap(FILE *fp, unsigned long pairs)
+{
+    putheader(fp, CBOR_MAP, pairs);
+}
+
+void cbor_putarraystart(FILE *fp)
+{
+    fputc((CBOR_ARRAY << 5) | CBOR_INDEFINITE, fp);
+}
+
+void cbor_putbreak(FILE *fp)
+{
+    fputc(CBOR_BREAK, fp);
+}
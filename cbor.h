@@ -0,0 +1,38 @@
+/* cbor.h: A minimal CBOR (RFC 8949) encoder.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_cbor_h_
+#define	_cbor_h_
+
+#include	<stdio.h>
+
+/* Write an unsigned integer.
+ */
+extern void cbor_putuint(FILE *fp, unsigned long long val);
+
+/* Write a text string of the given length. The string is assumed to
+ * be valid UTF-8.
+ */
+extern void cbor_puttext(FILE *fp, char const *str, unsigned long len);
+
+/* Write a NUL-terminated text string.
+ */
+extern void cbor_putcstr(FILE *fp, char const *str);
+
+/* Start a map holding the given number of key/value pairs.
+ */
+extern void cbor_putmap(FILE *fp, unsigned long pairs);
+
+/* Start an array of unknown length. It must be ended with
+ * cbor_putbreak().
+ */
+extern void cbor_putarraystart(FILE *fp);
+
+/* End an array of unknown length.
+ */
+extern void cbor_putbreak(FILE *fp);
+
+#endif
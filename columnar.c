@@ -0,0 +1,211 @@
+/* columnar.c: Writing solution fields as a binary columnar container.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	"err.h"
+#include	"solution.h"
+#include	"columnar.h"
+
+/*
+ * The container holds one row per level in the TWS file, stored as a
+ * set of fixed-width columns so that each one can be mmapped and used
+ * as a plain array. All numbers are little-endian.
+ *
+ * HEADER (16 bytes)
+ *  0-3   signature bytes ("TWSC")
+ *   4    container version (currently 1)
+ *   5    ruleset (1=Lynx, 2=MS)
+ *   6    number of columns
+ *   7    length of the levelset name
+ *  8-15  number of rows
+ *
+ * The header is followed by the levelset name (not NUL-terminated),
+ * padded with zeroes to a multiple of eight bytes, and then by one
+ * directory entry per column:
+ *
+ * COLUMN (32 bytes)
+ *  0-15  column name, padded with NULs
+ *  16    width of each value in bytes (1, 2, or 4)
+ * 17-23  zero
+ * 24-31  offset of the column's data from the start of the file
+ *
+ * The data of every column starts on an eight-byte boundary.
+ *
+ * Levels which have only a password have a movecount of zero and a
+ * besttime of 0x7FFFFFFF, and their remaining columns are zero.
+ */
+
+/* The signature bytes of the container.
+ */
+#define	COLSIG		"TWSC"
+#define	COLVERSION	1
+
+/* The columns, in the order in which they are stored.
+ */
+enum {
+    Col_Number,
+    Col_BestTime,
+    Col_RndSeed,
+    Col_RndSlideDir,
+    Col_Stepping,
+    Col_MoveCount,
+    Col_Count
+};
+
+static struct { char const *name; int width; } const columndefs[Col_Count] = {
+    { "number",		2 },
+    { "besttime",	4 },
+    { "rndseed",	4 },
+    { "rndslidedir",	1 },
+    { "stepping",	1 },
+    { "movecount",	4 }
+};
+
+struct columninfo {
+    int			ruleset;		/* the file's ruleset */
+    int			namelen;		/* length of levelset */
+    char		levelset[256];		/* name of the levelset */
+    unsigned long	count;			/* number of rows */
+    unsigned long	allocated;		/* number of rows allocated */
+    unsigned char      *data[Col_Count];	/* the column arrays */
+};
+
+#define	align8(n)	(((n) + 7) & ~7UL)
+
+/* Create an empty set of columns.
+ */
+columninfo *columnar_new(int ruleset, char const *levelset)
+{
+    columninfo *cols = NULL;
+
+    xalloc(cols, sizeof *cols);
+    memset(cols, 0, sizeof *cols);
+    cols->ruleset = ruleset;
+    if (levelset) {
+	cols->namelen = strlen(levelset);
+	if (cols->namelen > 255)
+	    cols->namelen = 255;
+	memcpy(cols->levelset, levelset, cols->namelen);
+    }
+    return cols;
+}
+
+/* Store val at row n of a column, little-endian.
+ */
+static void putvalue(columninfo *cols, int col, unsigned long n,
+		     unsigned long val)
+{
+    unsigned char      *p;
+    int			i;
+
+    p = cols->data[col] + n * columndefs[col].width;
+    for (i = 0 ; i < columndefs[col].width ; ++i, val >>= 8)
+	p[i] = val & 0xFF;
+}
+
+/* Append one row.
+ */
+void columnar_add(columninfo *cols, gamesetup const *game,
+		  solutioninfo const *solution)
+{
+    unsigned long	n;
+    int			i;
+
+    if (cols->count >= cols->allocated) {
+	cols->allocated = cols->allocated ? cols->allocated * 2 : 64;
+	for (i = 0 ; i < Col_Count ; ++i)
+	    xalloc(cols->data[i], cols->allocated * columndefs[i].width);
+    }
+    n = cols->count++;
+    putvalue(cols, Col_Number, n, game->number);
+    if (solution) {
+	putvalue(cols, Col_BestTime, n, game->besttime);
+	putvalue(cols, Col_RndSeed, n, solution->rndseed);
+	putvalue(cols, Col_RndSlideDir, n, solution->rndslidedir);
+	putvalue(cols, Col_Stepping, n, solution->stepping);
+	putvalue(cols, Col_MoveCount, n, solution->moves.count);
+    } else {
+	putvalue(cols, Col_BestTime, n, TIME_NIL);
+	putvalue(cols, Col_RndSeed, n, 0);
+	putvalue(cols, Col_RndSlideDir, n, 0);
+	putvalue(cols, Col_Stepping, n, 0);
+	putvalue(cols, Col_MoveCount, n, 0);
+    }
+}
+
+/* Write val to fp as a little-endian number of the given width.
+ */
+static void writele(FILE *fp, unsigned long long val, int width)
+{
+    for ( ; width ; --width, val >>= 8)
+	fputc((int)(val & 0xFF), fp);
+}
+
+/* Write zeroes to fp until pos is a multiple of eight.
+ */
+static unsigned long pad8(FILE *fp, unsigned long pos)
+{
+    for ( ; pos & 7 ; ++pos)
+	fputc(0, fp);
+    return pos;
+}
+
+/* Write the container to fp.
+ */
+int columnar_write(columninfo const *cols, FILE *fp)
+{
+    char		name[16];
+    unsigned long	pos, offset;
+    size_t		len;
+    int			i;
+
+    fputs(COLSIG, fp);
+    fputc(COLVERSION, fp);
+    fputc(cols->ruleset, fp);
+    fputc(Col_Count, fp);
+    fputc(cols->namelen, fp);
+    writele(fp, cols->count, 8);
+    fwrite(cols->levelset, 1, cols->namelen, fp);
+    pos = pad8(fp, 16 + cols->namelen);
+
+    offset = pos + 32 * Col_Count;
+    for (i = 0 ; i < Col_Count ; ++i) {
+	len = strlen(columndefs[i].name);
+	if (len > sizeof name)
+	    len = sizeof name;
+	memset(name, 0, sizeof name);
+	memcpy(name, columndefs[i].name, len);
+	fwrite(name, 1, sizeof name, fp);
+	writele(fp, columndefs[i].width, 8);
+	writele(fp, offset, 8);
+	offset = align8(offset + cols->count * columndefs[i].width);
+    }
+    pos += 32 * Col_Count;
+
+    for (i = 0 ; i < Col_Count ; ++i) {
+	if (cols->count)
+	    fwrite(cols->data[i], columndefs[i].width, cols->count, fp);
+	pos = pad8(fp, pos + cols->count * columndefs[i].width);
+    }
+
+    fflush(fp);
+    return ferror(fp) ? -1 : 0;
+}
+
+/* Free the columns.
+ */
+void columnar_free(columninfo *cols)
+{
+    int	i;
+
+    if (!cols)
+	return;
+    for (i = 0 ; i < Col_Count ; ++i)
+	free(cols->data[i]);
+    free(cols);
+}
@@ -0,0 +1,38 @@
+/* columnar.h: Writing solution fields as a binary columnar container.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_columnar_h_
+#define	_columnar_h_
+
+#include	<stdio.h>
+#include	"solution.h"
+
+/* The columns collected so far. The contents are private to
+ * columnar.c.
+ */
+typedef struct columninfo columninfo;
+
+/* Create an empty set of columns for a file with the given ruleset
+ * and levelset name.
+ */
+extern columninfo *columnar_new(int ruleset, char const *levelset);
+
+/* Append one row. solution is NULL for a level that only has a
+ * password.
+ */
+extern void columnar_add(columninfo *cols, gamesetup const *game,
+			 solutioninfo const *solution);
+
+/* Write the container to fp. The return value is negative if the
+ * write failed.
+ */
+extern int columnar_write(columninfo const *cols, FILE *fp);
+
+/* Free the columns.
+ */
+extern void columnar_free(columninfo *cols);
+
+#endif
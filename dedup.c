@@ -0,0 +1,382 @@
+/* dedup.c: Finding identical solutions across many TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<limits.h>
+#include	<inttypes.h>
+#include	<unistd.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/wait.h>
+#include	"err.h"
+#include	"fileio.h"
+#include	"solution.h"
+#include	"hash.h"
+#include	"trace.h"
+#include	"dedup.h"
+
+/* The fingerprint of one solution. Only the moves, which follow the
+ * sixteen-byte header, are hashed, so the same route recorded for a
+ * different password, or with a different random seed, is still
+ * recognized. The size is kept alongside the hash, so that a hash
+ * collision between routes of different lengths cannot join them.
+ */
+typedef struct fingerprint {
+    uint64_t		hash;
+    unsigned long	size;		/* size of the moves in bytes */
+    int			file;		/* index into the list of files */
+    int			level;
+} fingerprint;
+
+typedef struct fingerprintlist {
+    int			allocated;
+    int			count;
+    fingerprint	       *list;
+} fingerprintlist;
+
+typedef struct filelist {
+    int			allocated;
+    int			count;
+    char	      **names;
+} filelist;
+
+/* The state of a directory walk, passed through findfiles().
+ */
+typedef struct walkinfo {
+    filelist	       *files;
+    char const	       *dir;
+    int			ok;
+} walkinfo;
+
+static void addfile(filelist *files, char *name)
+{
+    if (files->count == files->allocated) {
+	files->allocated = files->allocated ? files->allocated * 2 : 64;
+	xalloc(files->names, files->allocated * sizeof *files->names);
+    }
+    files->names[files->count++] = name;
+}
+
+static int addpath(filelist *files, char const *path, int named);
+
+static int walkcallback(char *name, void *data)
+{
+    walkinfo   *walk = data;
+    char       *path;
+
+    path = getpathforfileindir(walk->dir, name);
+    if (!path) {
+	errmsg(name, "%s", strerror(errno));
+	walk->ok = FALSE;
+	return 0;
+    }
+    if (!addpath(walk->files, path, FALSE))
+	walk->ok = FALSE;
+    free(path);
+    return 0;
+}
+
+/* Add path to the list of files. Directories are searched for .tws
+ * files at any depth; files inside them with any other name are
+ * ignored, but a file that was named explicitly is always read. A
+ * symbolic link found in a directory is only followed to a file, so
+ * that a link back up the tree cannot make the search endless.
+ */
+static int addpath(filelist *files, char const *path, int named)
+{
+    struct stat	st;
+    walkinfo	walk;
+    char       *copy;
+    size_t	n;
+
+    if (named ? stat(path, &st) : lstat(path, &st)) {
+	errmsg(path, "%s", strerror(errno));
+	return FALSE;
+    }
+    if (S_ISLNK(st.st_mode)) {
+	if (stat(path, &st)) {
+	    errmsg(path, "%s", strerror(errno));
+	    return FALSE;
+	}
+	if (S_ISDIR(st.st_mode))
+	    return TRUE;
+    }
+    if (S_ISDIR(st.st_mode)) {
+	walk.files = files;
+	walk.dir = path;
+	walk.ok = TRUE;
+	return findfiles(path, &walk, walkcallback) && walk.ok;
+    }
+    n = strlen(path);
+    if (!named && (n < 4 || strcmp(path + n - 4, ".tws")))
+	return TRUE;
+    copy = NULL;
+    xalloc(copy, n + 1);
+    memcpy(copy, path, n + 1);
+    addfile(files, copy);
+    return TRUE;
+}
+
+static int cmpnames(void const *a, void const *b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* Fingerprint every solution in one file.
+ */
+static int scanfile(fingerprintlist *prints, char const *name, int index)
+{
+    fileinfo		file;
+    gamesetup		game;
+    fingerprint	       *fp;
+    unsigned char	extra[256];
+    int			ruleset, level, extrasize;
+    int			ok = TRUE;
+
+    clearfileinfo(&file);
+    if (!fileopen(&file, name, "rb", "file error"))
+	return FALSE;
+    if (!readsolutionheader(&file, &ruleset, &level, &extrasize, extra)) {
+	fileclose(&file, NULL);
+	return FALSE;
+    }
+
+    memset(&game, 0, sizeof game);
+    while (!filetestend(&file)) {
+	if (!readsolution(&file, &game)) {
+	    ok = FALSE;
+	    break;
+	}
+	if (game.number && game.solutionsize > 16) {
+	    if (prints->count == prints->allocated) {
+		prints->allocated = prints->allocated ? prints->allocated * 2
+						      : 1024;
+		xalloc(prints->list,
+		       prints->allocated * sizeof *prints->list);
+	    }
+	    fp = &prints->list[prints->count++];
+	    fp->size = game.solutionsize - 16;
+	    fp->hash = hash64(game.solutiondata + 16, fp->size);
+	    fp->file = index;
+	    fp->level = game.number;
+	}
+	clearsolution(&game);
+    }
+    clearsolution(&game);
+    fileclose(&file, NULL);
+    return ok;
+}
+
+/* Fingerprint the files whose index is congruent to first, modulo
+ * step.
+ */
+static int scanshare(fingerprintlist *prints, filelist const *files,
+		     int first, int step)
+{
+    double	start;
+    int		i, ok = TRUE;
+
+    for (i = first ; i < files->count ; i += step) {
+	start = trace_now();
+	if (!scanfile(prints, files->names[i], i))
+	    ok = FALSE;
+	trace_span("file", start, files->names[i], 0);
+    }
+    return ok;
+}
+
+/* Send a worker's fingerprints to the parent. Each write is a whole
+ * number of records no larger than PIPE_BUF, which the system
+ * guarantees will not be interleaved with the writes of the other
+ * workers.
+ */
+static int sendprints(int fd, fingerprintlist const *prints)
+{
+    int const	chunk = PIPE_BUF / sizeof(fingerprint);
+    char const *p = (char const*)prints->list;
+    ssize_t	n;
+    int		i, m;
+
+    for (i = 0 ; i < prints->count ; i += m) {
+	m = prints->count - i < chunk ? prints->count - i : chunk;
+	n = write(fd, p + i * sizeof(fingerprint), m * sizeof(fingerprint));
+	if (n != (ssize_t)(m * sizeof(fingerprint)))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/* Read the fingerprints sent by all of the workers.
+ */
+static int receiveprints(int fd, fingerprintlist *prints)
+{
+    size_t	have = 0;
+    ssize_t	n;
+
+    for (;;) {
+	if (prints->allocated * sizeof(fingerprint) - have < PIPE_BUF) {
+	    prints->allocated = prints->allocated ? prints->allocated * 2
+						  : 1024;
+	    xalloc(prints->list, prints->allocated * sizeof *prints->list);
+	}
+	n = read(fd, (char*)prints->list + have,
+		 prints->allocated * sizeof(fingerprint) - have);
+	if (n < 0 && errno == EINTR)
+	    continue;
+	if (n < 0) {
+	    warn("read: %s", strerror(errno));
+	    return FALSE;
+	}
+	if (n == 0)
+	    break;
+	have += n;
+    }
+    prints->count = have / sizeof(fingerprint);
+    return have % sizeof(fingerprint) == 0;
+}
+
+/* Fingerprint all of the files, using up to jobs processes.
+ */
+static int scanfiles(fingerprintlist *prints, filelist const *files,
+		     int jobs)
+{
+    fingerprintlist	mine, local;
+    pid_t		pid;
+    int			fds[2];
+    int			status, i, ok = TRUE;
+
+    if (jobs <= 0)
+	jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs > files->count)
+	jobs = files->count;
+    if (jobs <= 1)
+	return scanshare(prints, files, 0, 1);
+
+    if (pipe(fds)) {
+	warn("pipe: %s", strerror(errno));
+	return scanshare(prints, files, 0, 1);
+    }
+    memset(&local, 0, sizeof local);
+    fflush(NULL);
+    trace_flush();
+    for (i = 0 ; i < jobs ; ++i) {
+	pid = fork();
+	if (pid < 0) {
+	    warn("fork: %s", strerror(errno));
+	    if (!scanshare(&local, files, i, jobs))
+		ok = FALSE;
+	} else if (pid == 0) {
+	    close(fds[0]);
+	    memset(&mine, 0, sizeof mine);
+	    ok = scanshare(&mine, files, i, jobs);
+	    ok = sendprints(fds[1], &mine) && ok;
+	    trace_flush();
+	    _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+    }
+    close(fds[1]);
+    if (!receiveprints(fds[0], prints))
+	ok = FALSE;
+    close(fds[0]);
+    while (wait(&status) > 0)
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	    ok = FALSE;
+
+    /* Add the shares of any workers that could not be started.
+     */
+    if (local.count) {
+	xalloc(prints->list,
+	       (prints->count + local.count) * sizeof *prints->list);
+	memcpy(prints->list + prints->count, local.list,
+	       local.count * sizeof *local.list);
+	prints->count += local.count;
+	prints->allocated = prints->count;
+    }
+    free(local.list);
+    return ok;
+}
+
+static int cmpprints(void const *a, void const *b)
+{
+    fingerprint const  *x = a;
+    fingerprint const  *y = b;
+
+    if (x->hash != y->hash)
+	return x->hash < y->hash ? -1 : 1;
+    if (x->size != y->size)
+	return x->size < y->size ? -1 : 1;
+    if (x->file != y->file)
+	return x->file - y->file;
+    return x->level - y->level;
+}
+
+/* Find and report the duplicate solutions.
+ */
+int dedupfiles(char const *tablename, char **names, int count, int jobs)
+{
+    filelist		files;
+    fingerprintlist	prints;
+    fingerprint const  *fp;
+    FILE	       *table;
+    int			groups = 0, distinct = 0;
+    int			i, j, ok = TRUE;
+
+    memset(&files, 0, sizeof files);
+    for (i = 0 ; i < count ; ++i)
+	if (!addpath(&files, names[i], TRUE))
+	    ok = FALSE;
+    qsort(files.names, files.count, sizeof *files.names, cmpnames);
+
+    memset(&prints, 0, sizeof prints);
+    if (ok)
+	ok = scanfiles(&prints, &files, jobs);
+
+    if (ok) {
+	qsort(prints.list, prints.count, sizeof *prints.list, cmpprints);
+
+	if (!(table = fopen(tablename, "w"))) {
+	    errmsg(tablename, "%s", strerror(errno));
+	    ok = FALSE;
+	} else {
+	    for (i = 0 ; i < prints.count ; ++i) {
+		fp = &prints.list[i];
+		fprintf(table, "%016" PRIx64 "\t%s\t%d\n",
+			fp->hash, files.names[fp->file], fp->level);
+	    }
+	    if (fclose(table)) {
+		errmsg(tablename, "write error");
+		ok = FALSE;
+	    }
+	}
+
+	for (i = 0 ; i < prints.count ; i = j) {
+	    for (j = i + 1 ; j < prints.count ; ++j)
+		if (prints.list[j].hash != prints.list[i].hash
+				|| prints.list[j].size != prints.list[i].size)
+		    break;
+	    ++distinct;
+	    if (j - i < 2)
+		continue;
+	    ++groups;
+	    printf("%016" PRIx64, prints.list[i].hash);
+	    for ( ; i < j ; ++i)
+		printf("\t%s:%d", files.names[prints.list[i].file],
+		       prints.list[i].level);
+	    putchar('\n');
+	}
+	printf("%d solutions, %d distinct, %d duplicate groups\n",
+	       prints.count, distinct, groups);
+    }
+
+    for (i = 0 ; i < files.count ; ++i)
+	free(files.names[i]);
+    free(files.names);
+    free(prints.list);
+    return ok ? 0 : -1;
+}
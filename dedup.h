@@ -0,0 +1,20 @@
+/* dedup.h: Finding identical solutions across many TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_dedup_h_
+#define	_dedup_h_
+
+/* Fingerprint the moves of every solution in the named files, and in
+ * every .tws file found below the named directories, using up to jobs
+ * processes at once. The complete fingerprint table is written to
+ * tablename, with one line per solution, and each group of identical
+ * solutions is written to standard output. The return value is
+ * negative on failure.
+ */
+extern int dedupfiles(char const *tablename, char **names, int count,
+		      int jobs);
+
+#endif
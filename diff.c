@@ -0,0 +1,123 @@
+/* diff.c: Comparing the solutions in two TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	"err.h"
+#include	"fileio.h"
+#include	"solution.h"
+#include	"hash.h"
+#include	"leveltable.h"
+#include	"diff.h"
+
+/* What is known about one record of a file. The solution data itself
+ * is reduced to a hash as soon as it is read, and is never decoded:
+ * the level number and besttime are read straight from the header.
+ */
+typedef struct recordsum {
+    unsigned long	size;		/* 0 if absent, 6 if password only */
+    uint64_t		hash;		/* hash64() of the solution data */
+    int			besttime;
+} recordsum;
+
+/* One level of either file, as an entry of a leveltable.
+ */
+typedef struct levelpair {
+    int			number;		/* the level number */
+    recordsum		side[2];	/* the old and the new record */
+} levelpair;
+
+#define	issolved(r)		((r)->size > 16)
+
+/* Read one file into the given side of the index. If a level appears
+ * more than once, the last record wins, as it does in Tile World.
+ */
+static int readfile(leveltable *index, char const *name, int side)
+{
+    fileinfo		file;
+    gamesetup		game;
+    levelpair	       *slot;
+    unsigned char	extra[256];
+    int			ruleset, level, extrasize;
+    int			ok = TRUE;
+
+    clearfileinfo(&file);
+    if (!fileopen(&file, name, "rb", "file error"))
+	return FALSE;
+    if (!readsolutionheader(&file, &ruleset, &level, &extrasize, extra)) {
+	fileclose(&file, NULL);
+	return FALSE;
+    }
+
+    memset(&game, 0, sizeof game);
+    while (!filetestend(&file)) {
+	if (!readsolution(&file, &game)) {
+	    ok = FALSE;
+	    break;
+	}
+	if (game.number) {
+	    slot = leveltable_add(index, game.number, NULL);
+	    slot->side[side].size = game.solutionsize;
+	    slot->side[side].hash = hash64(game.solutiondata,
+					   game.solutionsize);
+	    slot->side[side].besttime = game.besttime;
+	}
+	clearsolution(&game);
+    }
+    clearsolution(&game);
+    fileclose(&file, NULL);
+    return ok;
+}
+
+/* Compare two files.
+ */
+int difffiles(char const *oldname, char const *newname, FILE *out)
+{
+    leveltable		index;
+    levelpair	       *pair;
+    recordsum const    *o, *n;
+    int			gained = 0, lost = 0, changed = 0, same = 0;
+    int			i, count;
+
+    leveltable_init(&index, sizeof(levelpair));
+    if (!readfile(&index, oldname, 0) || !readfile(&index, newname, 1)) {
+	leveltable_free(&index);
+	return -1;
+    }
+
+    count = leveltable_sort(&index);
+    for (i = 0 ; i < count ; ++i) {
+	pair = (levelpair*)index.slots + i;
+	o = &pair->side[0];
+	n = &pair->side[1];
+	if (o->size == n->size && o->hash == n->hash) {
+	    ++same;
+	} else if (!issolved(o) && issolved(n)) {
+	    fprintf(out, "level %d: gained, besttime %d\n",
+		    pair->number, n->besttime);
+	    ++gained;
+	} else if (issolved(o) && !issolved(n)) {
+	    fprintf(out, "level %d: lost, besttime was %d\n",
+		    pair->number, o->besttime);
+	    ++lost;
+	} else if (issolved(o)) {
+	    fprintf(out, "level %d: changed, besttime %d -> %d (%+d)\n",
+		    pair->number, o->besttime, n->besttime,
+		    n->besttime - o->besttime);
+	    ++changed;
+	} else {
+	    /* Only the password record was added, removed or altered.
+	     */
+	    ++same;
+	}
+    }
+    fprintf(out, "%d gained, %d lost, %d changed, %d unchanged\n",
+	    gained, lost, changed, same);
+
+    leveltable_free(&index);
+    return gained || lost || changed;
+}
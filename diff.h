@@ -0,0 +1,20 @@
+/* diff.h: Comparing the solutions in two TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_diff_h_
+#define	_diff_h_
+
+#include	<stdio.h>
+
+/* Compare the solutions in the files oldname and newname, and write a
+ * line to out for each level that gained, lost or changed a solution,
+ * followed by a summary line. The return value is 0 if the files hold
+ * the same solutions, 1 if they differ, and -1 if either file could
+ * not be read.
+ */
+extern int difffiles(char const *oldname, char const *newname, FILE *out);
+
+#endif
@@ -0,0 +1,69 @@
+/* hash.c: Fast non-cryptographic hashing of solution data.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<string.h>
+#include	<stdint.h>
+#include	"hash.h"
+
+/* This is MurmurHash64A by Austin Appleby, which is in the public
+ * domain. It consumes eight bytes per step, which makes it several
+ * times faster than a bytewise hash on solutions of any length.
+ */
+#define	HASH_M		UINT64_C(0xC6A4A7935BD1E995)
+#define	HASH_R		47
+#define	HASH_SEED	UINT64_C(0x54575332)	/* "TWS2" */
+
+static uint64_t load64(unsigned char const *p)
+{
+    uint64_t	k;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(&k, p, 8);
+#else
+    k = (uint64_t)p[0]	     | (uint64_t)p[1] << 8
+      | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24
+      | (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40
+      | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+#endif
+    return k;
+}
+
+uint64_t hash64(void const *data, size_t size)
+{
+    unsigned char const	*p = data;
+    uint64_t		 h, k;
+
+    h = HASH_SEED ^ (size * HASH_M);
+    for ( ; size >= 8 ; p += 8, size -= 8) {
+	k = load64(p);
+	k *= HASH_M;
+	k ^= k >> HASH_R;
+	k *= HASH_M;
+	h ^= k;
+	h *= HASH_M;
+    }
+    switch (size) {
+      case 7:
+	h ^= (uint64_t)p[6] << 48;	/* fall through */
+      case 6:
+	h ^= (uint64_t)p[5] << 40;	/* fall through */
+      case 5:
+	h ^= (uint64_t)p[4] << 32;	/* fall through */
+      case 4:
+	h ^= (uint64_t)p[3] << 24;	/* fall through */
+      case 3:
+	h ^= (uint64_t)p[2] << 16;	/* fall through */
+      case 2:
+	h ^= (uint64_t)p[1] << 8;	/* fall through */
+      case 1:
+	h ^= (uint64_t)p[0];
+	h *= HASH_M;
+    }
+    h ^= h >> HASH_R;
+    h *= HASH_M;
+    h ^= h >> HASH_R;
+    return h;
+}
@@ -0,0 +1,19 @@
+/* hash.h: Fast non-cryptographic hashing of solution data.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_hash_h_
+#define	_hash_h_
+
+#include	<stddef.h>
+#include	<stdint.h>
+
+/* Return a 64-bit hash of size bytes at data. The bytes are read in
+ * little-endian order, so the result is the same on every machine and
+ * can be stored or compared across runs.
+ */
+extern uint64_t hash64(void const *data, size_t size);
+
+#endif
@@ -0,0 +1,223 @@
+/* isa.c: Choosing vectorized kernels for the CPU at run time.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdint.h>
+#include	<string.h>
+#include	"err.h"
+#include	"isa.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define	X86KERNELS
+#include	<immintrin.h>
+#endif
+
+static char const *isanames[Isa_Count] = {
+    "generic", "sse2", "sse4.2", "avx2", "avx512"
+};
+
+static int currentisa = Isa_Generic;
+
+static size_t jsonscan_generic(char const *s)
+{
+    unsigned char const	       *p = (unsigned char const*)s;
+
+    while (*p >= 0x20 && *p != '"' && *p != '\\')
+	++p;
+    return p - (unsigned char const*)s;
+}
+
+size_t (*jsonscan)(char const *s) = jsonscan_generic;
+
+#ifdef X86KERNELS
+
+/* The vector kernels read whole aligned blocks, starting with the
+ * one that holds s, and ignore the bits of the bytes before s. An
+ * aligned block never crosses a page boundary, so the bytes read past
+ * the terminating NUL are always readable. A byte b is a control
+ * character if max(b, 0x1F) == 0x1F, as SSE2 has no unsigned compare.
+ */
+
+__attribute__((target("sse2")))
+static unsigned scanblock_sse2(char const *p)
+{
+    __m128i	v = _mm_load_si128((__m128i const*)p);
+    __m128i	m;
+
+    m = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)),
+		       _mm_set1_epi8(0x1F));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    return _mm_movemask_epi8(m);
+}
+
+__attribute__((target("sse2")))
+static size_t jsonscan_sse2(char const *s)
+{
+    unsigned	off = (uintptr_t)s & 15;
+    char const *p = s - off;
+    unsigned	mask;
+
+    mask = scanblock_sse2(p) >> off << off;
+    while (!mask) {
+	p += 16;
+	mask = scanblock_sse2(p);
+    }
+    return p + __builtin_ctz(mask) - s;
+}
+
+/* SSE4.2 matches all three kinds of character with one instruction,
+ * as byte ranges: 0x00-0x1F, '"'-'"' and '\\'-'\\'.
+ */
+__attribute__((target("sse4.2")))
+static unsigned scanblock_sse42(char const *p)
+{
+    __m128i const	ranges = _mm_setr_epi8(0x00, 0x1F, '"', '"',
+					       '\\', '\\', 0, 0,
+					       0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i		v = _mm_load_si128((__m128i const*)p);
+
+    return _mm_cvtsi128_si32(_mm_cmpestrm(ranges, 6, v, 16,
+					  _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES
+					  | _SIDD_BIT_MASK));
+}
+
+__attribute__((target("sse4.2")))
+static size_t jsonscan_sse42(char const *s)
+{
+    unsigned	off = (uintptr_t)s & 15;
+    char const *p = s - off;
+    unsigned	mask;
+
+    mask = scanblock_sse42(p) >> off << off;
+    while (!mask) {
+	p += 16;
+	mask = scanblock_sse42(p);
+    }
+    return p + __builtin_ctz(mask) - s;
+}
+
+__attribute__((target("avx2")))
+static unsigned scanblock_avx2(char const *p)
+{
+    __m256i	v = _mm256_load_si256((__m256i const*)p);
+    __m256i	m;
+
+    m = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)),
+			  _mm256_set1_epi8(0x1F));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    return (unsigned)_mm256_movemask_epi8(m);
+}
+
+__attribute__((target("avx2")))
+static size_t jsonscan_avx2(char const *s)
+{
+    unsigned	off = (uintptr_t)s & 31;
+    char const *p = s - off;
+    unsigned	mask;
+
+    mask = scanblock_avx2(p) >> off << off;
+    while (!mask) {
+	p += 32;
+	mask = scanblock_avx2(p);
+    }
+    return p + __builtin_ctz(mask) - s;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static uint64_t scanblock_avx512(char const *p)
+{
+    __m512i	v = _mm512_load_si512((void const*)p);
+
+    return _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1F))
+	 | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'))
+	 | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t jsonscan_avx512(char const *s)
+{
+    unsigned	off = (uintptr_t)s & 63;
+    char const *p = s - off;
+    uint64_t	mask;
+
+    mask = scanblock_avx512(p) >> off << off;
+    while (!mask) {
+	p += 64;
+	mask = scanblock_avx512(p);
+    }
+    return p + __builtin_ctzll(mask) - s;
+}
+
+#endif
+
+/* Return nonzero if the CPU, and the operating system, support the
+ * given instruction set.
+ */
+static int supported(int isa)
+{
+#ifdef X86KERNELS
+    __builtin_cpu_init();
+    switch (isa) {
+      case Isa_Generic:	return 1;
+      case Isa_SSE2:	return __builtin_cpu_supports("sse2");
+      case Isa_SSE42:	return __builtin_cpu_supports("sse4.2");
+      case Isa_AVX2:	return __builtin_cpu_supports("avx2");
+      case Isa_AVX512:	return __builtin_cpu_supports("avx512bw");
+    }
+    return 0;
+#else
+    return isa == Isa_Generic;
+#endif
+}
+
+static void bind(int isa)
+{
+    currentisa = isa;
+    switch (isa) {
+#ifdef X86KERNELS
+      case Isa_SSE2:	jsonscan = jsonscan_sse2;	break;
+      case Isa_SSE42:	jsonscan = jsonscan_sse42;	break;
+      case Isa_AVX2:	jsonscan = jsonscan_avx2;	break;
+      case Isa_AVX512:	jsonscan = jsonscan_avx512;	break;
+#endif
+      default:		jsonscan = jsonscan_generic;	break;
+    }
+}
+
+void isa_init(void)
+{
+    int	isa;
+
+    for (isa = Isa_Count - 1 ; isa > Isa_Generic ; --isa)
+	if (supported(isa))
+	    break;
+    bind(isa);
+}
+
+int isa_force(char const *name)
+{
+    int	isa;
+
+    for (isa = 0 ; isa < Isa_Count ; ++isa)
+	if (!strcmp(name, isanames[isa]))
+	    break;
+    if (isa == Isa_Count) {
+	errmsg(name, "unknown instruction set");
+	return -1;
+    }
+    if (!supported(isa)) {
+	errmsg(name, "not supported by this CPU");
+	return -1;
+    }
+    bind(isa);
+    return 0;
+}
+
+char const *isa_name(void)
+{
+    return isanames[currentisa];
+}
@@ -0,0 +1,48 @@
+/* isa.h: Choosing vectorized kernels for the CPU at run time.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_isa_h_
+#define	_isa_h_
+
+#include	<stddef.h>
+
+/* The instruction sets that kernels are written for, from the least
+ * to the most capable.
+ */
+enum {
+    Isa_Generic = 0,	/* plain C */
+    Isa_SSE2,
+    Isa_SSE42,
+    Isa_AVX2,
+    Isa_AVX512,		/* AVX-512BW */
+    Isa_Count
+};
+
+/* Return the length of the longest prefix of the NUL-terminated
+ * string s that can appear in a JSON string as it is, which is the
+ * offset of the first '"', '\\' or control character. The NUL at the
+ * end counts as a control character. This is used to copy strings in
+ * the JSON parser and to find the characters to escape in the output.
+ */
+extern size_t (*jsonscan)(char const *s);
+
+/* Bind the kernels to the best versions the CPU supports. Until this
+ * is called, the generic versions are used.
+ */
+extern void isa_init(void);
+
+/* Bind the kernels to the versions for the named instruction set:
+ * "generic", "sse2", "sse4.2", "avx2" or "avx512". -1 is returned, and
+ * an error is displayed, if the name is unknown or the CPU does not
+ * support it.
+ */
+extern int isa_force(char const *name);
+
+/* Return the name of the instruction set currently in use.
+ */
+extern char const *isa_name(void);
+
+#endif
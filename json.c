@@ -0,0 +1,355 @@
+/* json.c: A small in-place JSON parser.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<limits.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	"err.h"
+#include	"isa.h"
+#include	"json.h"
+
+#ifndef	TRUE
+#define	TRUE	1
+#endif
+#ifndef	FALSE
+#define	FALSE	0
+#endif
+
+/* How deeply arrays and objects may be nested.
+ */
+#define	MAXDEPTH	64
+
+/* The parser's position.
+ */
+typedef struct jsonparser {
+    char       *start;		/* the beginning of the text */
+    char       *p;		/* the current position */
+} jsonparser;
+
+static int parsevalue(jsonparser *jp, jsonvalue *value, int depth);
+
+/* Display an error message giving the offset at which it occurred.
+ */
+static int parseerr(jsonparser const *jp, char const *msg)
+{
+    errmsg("json", "%s at offset %ld", msg, (long)(jp->p - jp->start));
+    return FALSE;
+}
+
+char *json_skipspace(char *text)
+{
+    while (*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r')
+	++text;
+    return text;
+}
+
+/* Add room for one more item to an array or object.
+ */
+static jsonvalue *newitem(jsonvalue *value, int *allocated)
+{
+    jsonvalue  *item;
+
+    if (value->count >= *allocated) {
+	*allocated = *allocated ? *allocated * 2 : 8;
+	xalloc(value->items, *allocated * sizeof *value->items);
+	if (value->type == JSON_Object)
+	    xalloc(value->keys, *allocated * sizeof *value->keys);
+    }
+    item = &value->items[value->count++];
+    memset(item, 0, sizeof *item);
+    return item;
+}
+
+/* Read four hex digits.
+ */
+static int parsehex4(jsonparser *jp, unsigned long *code)
+{
+    int	i, ch;
+
+    *code = 0;
+    for (i = 0 ; i < 4 ; ++i) {
+	ch = *jp->p++;
+	if (ch >= '0' && ch <= '9')
+	    *code = (*code << 4) | (ch - '0');
+	else if (ch >= 'a' && ch <= 'f')
+	    *code = (*code << 4) | (ch - 'a' + 10);
+	else if (ch >= 'A' && ch <= 'F')
+	    *code = (*code << 4) | (ch - 'A' + 10);
+	else
+	    return parseerr(jp, "bad \\u escape");
+    }
+    return TRUE;
+}
+
+/* Parse a string, decoding it in place. The decoded text is never
+ * longer than the encoded text, so it can overwrite it.
+ */
+static int parsestring(jsonparser *jp, char **str, int *len)
+{
+    unsigned long	code, low;
+    char	       *out;
+    size_t		n;
+
+    ++jp->p;
+    *str = out = jp->p;
+    for (;;) {
+	switch (*jp->p) {
+	  case '\0':
+	    return parseerr(jp, "unterminated string");
+	  case '"':
+	    ++jp->p;
+	    *out = '\0';
+	    *len = out - *str;
+	    return TRUE;
+	  case '\\':
+	    ++jp->p;
+	    switch (*jp->p++) {
+	      case '"':	*out++ = '"';	break;
+	      case '\\': *out++ = '\\';	break;
+	      case '/':	*out++ = '/';	break;
+	      case 'b':	*out++ = '\b';	break;
+	      case 'f':	*out++ = '\f';	break;
+	      case 'n':	*out++ = '\n';	break;
+	      case 'r':	*out++ = '\r';	break;
+	      case 't':	*out++ = '\t';	break;
+	      case 'u':
+		if (!parsehex4(jp, &code))
+		    return FALSE;
+		if (code >= 0xD800 && code < 0xDC00 && jp->p[0] == '\\'
+						    && jp->p[1] == 'u') {
+		    jp->p += 2;
+		    if (!parsehex4(jp, &low))
+			return FALSE;
+		    if (low < 0xDC00 || low >= 0xE000)
+			return parseerr(jp, "bad surrogate pair");
+		    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+		}
+		if (code < 0x80) {
+		    *out++ = code;
+		} else if (code < 0x800) {
+		    *out++ = 0xC0 | (code >> 6);
+		    *out++ = 0x80 | (code & 0x3F);
+		} else if (code < 0x10000) {
+		    *out++ = 0xE0 | (code >> 12);
+		    *out++ = 0x80 | ((code >> 6) & 0x3F);
+		    *out++ = 0x80 | (code & 0x3F);
+		} else {
+		    *out++ = 0xF0 | (code >> 18);
+		    *out++ = 0x80 | ((code >> 12) & 0x3F);
+		    *out++ = 0x80 | ((code >> 6) & 0x3F);
+		    *out++ = 0x80 | (code & 0x3F);
+		}
+		break;
+	      default:
+		--jp->p;
+		return parseerr(jp, "bad escape in string");
+	    }
+	    break;
+	  default:
+	    if ((unsigned char)*jp->p < 0x20)
+		return parseerr(jp, "control character in string");
+	    // Copy the whole run up to the next special character,
+	    // which for a movestring is usually the closing quote.
+	    n = jsonscan(jp->p);
+	    if (out != jp->p)
+		memmove(out, jp->p, n);
+	    out += n;
+	    jp->p += n;
+	    break;
+	}
+    }
+}
+
+/* Parse a number, which is left in place.
+ */
+static int parsenumber(jsonparser *jp, jsonvalue *value)
+{
+    char       *p = jp->p;
+
+    if (*p == '-')
+	++p;
+    if (*p == '0') {
+	++p;
+    } else if (*p >= '1' && *p <= '9') {
+	while (*p >= '0' && *p <= '9')
+	    ++p;
+    } else {
+	return parseerr(jp, "bad number");
+    }
+    if (*p == '.') {
+	++p;
+	if (!(*p >= '0' && *p <= '9'))
+	    return parseerr(jp, "bad number");
+	while (*p >= '0' && *p <= '9')
+	    ++p;
+    }
+    if (*p == 'e' || *p == 'E') {
+	++p;
+	if (*p == '+' || *p == '-')
+	    ++p;
+	if (!(*p >= '0' && *p <= '9'))
+	    return parseerr(jp, "bad number");
+	while (*p >= '0' && *p <= '9')
+	    ++p;
+    }
+    value->type = JSON_Number;
+    value->str = jp->p;
+    value->len = p - jp->p;
+    jp->p = p;
+    return TRUE;
+}
+
+/* Parse an array or an object.
+ */
+static int parsecontainer(jsonparser *jp, jsonvalue *value, int depth)
+{
+    jsonvalue  *item;
+    char	close;
+    int		allocated = 0;
+    int		len;
+
+    if (depth >= MAXDEPTH)
+	return parseerr(jp, "nesting too deep");
+    close = *jp->p == '[' ? ']' : '}';
+    value->type = close == ']' ? JSON_Array : JSON_Object;
+    jp->p = json_skipspace(jp->p + 1);
+    if (*jp->p == close) {
+	++jp->p;
+	return TRUE;
+    }
+    for (;;) {
+	item = newitem(value, &allocated);
+	if (value->type == JSON_Object) {
+	    value->keys[value->count - 1] = NULL;
+	    if (*jp->p != '"')
+		return parseerr(jp, "expected member name");
+	    if (!parsestring(jp, &value->keys[value->count - 1], &len))
+		return FALSE;
+	    jp->p = json_skipspace(jp->p);
+	    if (*jp->p != ':')
+		return parseerr(jp, "expected ':'");
+	    jp->p = json_skipspace(jp->p + 1);
+	}
+	if (!parsevalue(jp, item, depth + 1))
+	    return FALSE;
+	jp->p = json_skipspace(jp->p);
+	if (*jp->p == close) {
+	    ++jp->p;
+	    return TRUE;
+	}
+	if (*jp->p != ',')
+	    return parseerr(jp, close == ']' ? "expected ',' or ']'"
+					     : "expected ',' or '}'");
+	jp->p = json_skipspace(jp->p + 1);
+    }
+}
+
+/* Compare the text at the current position with a literal.
+ */
+static int parseliteral(jsonparser *jp, char const *lit, int type,
+			jsonvalue *value)
+{
+    int	n = strlen(lit);
+
+    if (strncmp(jp->p, lit, n))
+	return parseerr(jp, "unexpected character");
+    jp->p += n;
+    value->type = type;
+    return TRUE;
+}
+
+static int parsevalue(jsonparser *jp, jsonvalue *value, int depth)
+{
+    switch (*jp->p) {
+      case '{':
+      case '[':
+	return parsecontainer(jp, value, depth);
+      case '"':
+	value->type = JSON_String;
+	return parsestring(jp, &value->str, &value->len);
+      case 't':
+	return parseliteral(jp, "true", JSON_True, value);
+      case 'f':
+	return parseliteral(jp, "false", JSON_False, value);
+      case 'n':
+	return parseliteral(jp, "null", JSON_Null, value);
+      case '\0':
+	return parseerr(jp, "unexpected end of text");
+      default:
+	return parsenumber(jp, value);
+    }
+}
+
+/* Parse one JSON value from text.
+ */
+int json_parse(char *text, char **end, jsonvalue *value)
+{
+    jsonparser	jp;
+    int		r;
+
+    memset(value, 0, sizeof *value);
+    jp.start = text;
+    jp.p = json_skipspace(text);
+    r = parsevalue(&jp, value, 0);
+    if (end)
+	*end = jp.p;
+    return r;
+}
+
+/* Free the memory allocated for a parsed value.
+ */
+void json_free(jsonvalue *value)
+{
+    int	i;
+
+    for (i = 0 ; i < value->count ; ++i)
+	json_free(&value->items[i]);
+    free(value->items);
+    free(value->keys);
+    memset(value, 0, sizeof *value);
+}
+
+/* Return the value of the named member of an object.
+ */
+jsonvalue const *json_get(jsonvalue const *obj, char const *key)
+{
+    int	i;
+
+    if (!obj || obj->type != JSON_Object)
+	return NULL;
+    for (i = 0 ; i < obj->count ; ++i)
+	if (obj->keys[i] && !strcmp(obj->keys[i], key))
+	    return &obj->items[i];
+    return NULL;
+}
+
+/* Return TRUE if value is a string equal to str.
+ */
+int json_isstring(jsonvalue const *value, char const *str)
+{
+    return value && value->type == JSON_String && !strcmp(value->str, str);
+}
+
+/* Convert a number to an unsigned long.
+ */
+int json_getulong(jsonvalue const *value, unsigned long *num)
+{
+    unsigned long	n = 0;
+    int			i;
+
+    if (!value || value->type != JSON_Number)
+	return FALSE;
+    for (i = 0 ; i < value->len ; ++i) {
+	if (value->str[i] < '0' || value->str[i] > '9')
+	    return FALSE;
+	if (n > (ULONG_MAX - (value->str[i] - '0')) / 10)
+	    return FALSE;
+	n = n * 10 + (value->str[i] - '0');
+    }
+    *num = n;
+    return TRUE;
+}
@@ -0,0 +1,66 @@
+/* json.h: A small in-place JSON parser.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_json_h_
+#define	_json_h_
+
+/* The types of JSON values.
+ */
+enum {
+    JSON_Null = 0,
+    JSON_False,
+    JSON_True,
+    JSON_Number,
+    JSON_String,
+    JSON_Array,
+    JSON_Object
+};
+
+/* A parsed JSON value. Strings and numbers point into the parsed
+ * text, which must therefore outlive the value. Strings have their
+ * escapes decoded and are NUL-terminated; numbers are not terminated,
+ * and len gives their length.
+ */
+typedef struct jsonvalue {
+    int			type;		/* one of the JSON_* values */
+    char	       *str;		/* text of a string or number */
+    int			len;		/* length of str */
+    int			count;		/* number of items or members */
+    char	      **keys;		/* member names of an object */
+    struct jsonvalue   *items;		/* array items or member values */
+} jsonvalue;
+
+/* Parse one JSON value from text, which is modified in place. end
+ * receives a pointer to the first character after the value. FALSE
+ * is returned, and an error is displayed, if the text is not valid.
+ * The value must be freed with json_free() whether or not the parse
+ * succeeded.
+ */
+extern int json_parse(char *text, char **end, jsonvalue *value);
+
+/* Free the memory allocated for a parsed value.
+ */
+extern void json_free(jsonvalue *value);
+
+/* Return the value of the named member of an object, or NULL if obj
+ * is not an object or has no such member.
+ */
+extern jsonvalue const *json_get(jsonvalue const *obj, char const *key);
+
+/* Return TRUE if value is a string equal to str.
+ */
+extern int json_isstring(jsonvalue const *value, char const *str);
+
+/* Convert a number to an unsigned long. FALSE is returned if value is
+ * not a non-negative integer, or is too large for an unsigned long.
+ */
+extern int json_getulong(jsonvalue const *value, unsigned long *num);
+
+/* Return a pointer past any whitespace at the start of text.
+ */
+extern char *json_skipspace(char *text);
+
+#endif
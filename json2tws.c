@@ -0,0 +1,307 @@
+/* json2tws.c: Convert the JSON format back to a Tile World solution file.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "solution.h"
+#include "fileio.h"
+#include "json.h"
+#include "isa.h"
+#include "movestr.h"
+#include "err.h"
+
+/* The size of the output buffer.
+ */
+#define OUTBUFSIZE (64 * 1024)
+
+typedef struct json2twsinfo {
+    fileinfo	*out;
+    int		headerdone;	/* TRUE once the TWS header is written */
+    solutioninfo solution;	/* reused for every level */
+    gamesetup	game;		/* reused for every level */
+    solutionbuf	packed;		/* reused for every level */
+} json2twsinfo;
+
+/**
+ * Read a whole file into a NUL-terminated buffer.
+ */
+char *readwholefile(fileinfo *file)
+{
+    char *buf;
+    long size;
+
+    if (fseek(file->fp, 0, SEEK_END) || (size = ftell(file->fp)) < 0
+				      || fseek(file->fp, 0, SEEK_SET)) {
+	fileerr(file, "cannot determine file size");
+	return NULL;
+    }
+    buf = NULL;
+    xalloc(buf, size + 1);
+    if (!fileread(file, buf, size, "read error")) {
+	free(buf);
+	return NULL;
+    }
+    buf[size] = '\0';
+    return buf;
+}
+
+/**
+ * Write the TWS header from the header fields of a document.
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+int writeheader(json2twsinfo *self, jsonvalue const *doc)
+{
+    jsonvalue const *levelset;
+    unsigned long currentlevel = 0;
+    int ruleset;
+
+    if (json_isstring(json_get(doc, "ruleset"), "lynx")) {
+	ruleset = Ruleset_Lynx;
+    } else if (json_isstring(json_get(doc, "ruleset"), "ms")) {
+	ruleset = Ruleset_MS;
+    } else {
+	errmsg("error", "missing or unknown ruleset");
+	return -1;
+    }
+    if (json_get(doc, "currentlevel")
+		&& !json_getulong(json_get(doc, "currentlevel"), &currentlevel)) {
+	errmsg("error", "bad currentlevel");
+	return -1;
+    }
+
+    if (!writesolutionheader(self->out, ruleset, currentlevel, 0, NULL)) {
+	return -1;
+    }
+    levelset = json_get(doc, "levelset");
+    if (levelset && levelset->type == JSON_String) {
+	if (!writesolutionsetname(self->out, levelset->str)) {
+	    return -1;
+	}
+    }
+    self->headerdone = 1;
+    return 0;
+}
+
+/**
+ * Convert one solution object and write it out.
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+int writejsonsolution(json2twsinfo *self, jsonvalue const *obj)
+{
+    solutioninfo *solution = &self->solution;
+    gamesetup *game = &self->game;
+    jsonvalue const *passwd, *moves;
+    unsigned long number, val, solutiontime;
+    int ok;
+
+    if (!json_getulong(json_get(obj, "number"), &number) || number > 0xFFFF) {
+	errmsg("error", "solution has a missing or bad number");
+	return -1;
+    }
+    passwd = json_get(obj, "password");
+    if (!passwd || passwd->type != JSON_String || passwd->len != 4) {
+	errmsg("error", "level %lu: missing or bad password", number);
+	return -1;
+    }
+
+    clearsolution(game);
+    game->number = number;
+    memcpy(game->passwd, passwd->str, 5);
+    game->sgflags = SGF_HASPASSWD;
+
+    moves = json_get(obj, "moves");
+    if (moves == NULL) {
+	return writesolution(self->out, game) ? 0 : -1;
+    }
+    if (moves->type != JSON_String
+		|| !parsemovestring(moves->str, &solution->moves, &solutiontime)) {
+	errmsg("error", "level %lu: bad movestring", number);
+	return -1;
+    }
+
+    solution->flags = 0;
+    solution->rndslidedir = NORTH;
+    solution->stepping = 0;
+    // expandsolution() sign-extends a seed with its top bit set, and
+    // tws2json writes it that way, so that form is accepted as well.
+    if (!json_getulong(json_get(obj, "rndseed"), &val)
+		|| (val > 0xFFFFFFFFUL && val < ~0x7FFFFFFFUL)) {
+	errmsg("error", "level %lu: bad rndseed", number);
+	return -1;
+    }
+    solution->rndseed = val;
+    if (json_get(obj, "rndslidedir")) {
+	if (!json_getulong(json_get(obj, "rndslidedir"), &val)
+		|| (val != NORTH && val != WEST && val != SOUTH && val != EAST)) {
+	    errmsg("error", "level %lu: bad rndslidedir", number);
+	    return -1;
+	}
+	solution->rndslidedir = val;
+    }
+    if (json_get(obj, "stepping")) {
+	if (!json_getulong(json_get(obj, "stepping"), &val) || val > 7) {
+	    errmsg("error", "level %lu: bad stepping", number);
+	    return -1;
+	}
+	solution->stepping = val;
+    }
+    game->besttime = solutiontime;
+    if (json_getulong(json_get(obj, "solution_time"), &val)) {
+	game->besttime = val;
+    }
+
+    if (!contractsolutionbuf(solution, game, &self->packed)) {
+	return -1;
+    }
+    // Lend the packed buffer to game just long enough to write it.
+    game->solutiondata = self->packed.data;
+    game->solutionsize = self->packed.size;
+    ok = writesolution(self->out, game);
+    game->solutiondata = NULL;
+    game->solutionsize = 0;
+    return ok ? 0 : -1;
+}
+
+/**
+ * Handle one top-level value: either a whole document, or one line
+ * of newline-delimited JSON.
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+int convertvalue(json2twsinfo *self, jsonvalue const *value)
+{
+    jsonvalue const *solutions;
+    int i;
+
+    if (json_isstring(json_get(value, "class"), "solution")) {
+	if (!self->headerdone) {
+	    // A bare NDJSON solution line carries the file's fields.
+	    if (writeheader(self, value) < 0) {
+		return -1;
+	    }
+	}
+	return writejsonsolution(self, value);
+    }
+    if (!json_isstring(json_get(value, "class"), "tws")) {
+	errmsg("error", "not a tws document");
+	return -1;
+    }
+    if (!self->headerdone && writeheader(self, value) < 0) {
+	return -1;
+    }
+    solutions = json_get(value, "solutions");
+    if (solutions == NULL) {
+	return 0;
+    }
+    if (solutions->type != JSON_Array) {
+	errmsg("error", "solutions is not an array");
+	return -1;
+    }
+    for (i = 0; i < solutions->count; i++) {
+	if (writejsonsolution(self, &solutions->items[i]) < 0) {
+	    return -1;
+	}
+    }
+    return 0;
+}
+
+static void usage(FILE *fp)
+{
+	fprintf(fp, "usage: json2tws [--force-isa=isa] file.json [file.tws]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static struct option const longopts[] = {
+		{ "force-isa",	required_argument,	NULL, 'I' },
+		{ "help",	no_argument,		NULL, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+	json2twsinfo self;
+	fileinfo in, out;
+	jsonvalue value;
+	char *text, *p;
+	char const *outpath;
+	int ch, r = 0;
+
+	isa_init();
+	while ((ch = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+		switch (ch) {
+		case 'I':
+			if (isa_force(optarg) < 0) {
+				return 1;
+			}
+			break;
+		case 'h':
+			usage(stdout);
+			return 0;
+		default:
+			usage(stderr);
+			return 1;
+		}
+	}
+	if (argc - optind < 1 || argc - optind > 2) {
+		usage(stderr);
+		return 1;
+	}
+	outpath = argc - optind == 2 ? argv[optind + 1] : NULL;
+
+	clearfileinfo(&in);
+	if (!fileopen(&in, argv[optind], "rb", "file error")) {
+		return 1;
+	}
+	text = readwholefile(&in);
+	fileclose(&in, "error");
+	if (text == NULL) {
+		return 1;
+	}
+
+	clearfileinfo(&out);
+	if (outpath) {
+		if (!fileopen(&out, outpath, "wb", "file error")) {
+			free(text);
+			return 1;
+		}
+	} else {
+		out.name = "stdout";
+		out.fp = stdout;
+	}
+	setvbuf(out.fp, NULL, _IOFBF, OUTBUFSIZE);
+
+	memset(&self, 0, sizeof self);
+	self.out = &out;
+
+	// Accept both a single document and newline-delimited JSON.
+	p = json_skipspace(text);
+	while (*p && r == 0) {
+		if (!json_parse(p, &p, &value)) {
+			r = -1;
+		} else {
+			r = convertvalue(&self, &value);
+		}
+		json_free(&value);
+		p = json_skipspace(p);
+	}
+
+	clearsolution(&self.game);
+	destroymovelist(&self.solution.moves);
+	free(self.packed.data);
+	free(text);
+	if (fflush(out.fp) != 0) {
+		fileerr(&out, "write error");
+		r = -1;
+	}
+	if (outpath) {
+		fileclose(&out, "error");
+	}
+
+	return r < 0 ? 1 : 0;
+}
@@ -0,0 +1,510 @@
+/* jsoncompress.c: Converting lists of moves to movestrings.
+ *
+ * Copyright © 2011 by Andrew Ekstedt, under the GNU General Public
+ * License. No warranty. See COPYING for details.
+ */
+
+#include <stdio.h>
+
+#include "bstrlib.h"
+
+#include "solution.h"
+#include "err.h"
+#include "jsoncompress.h"
+
+/**
+ * Append a decimal number to the movestring buffer. bformata() would
+ * allocate a temporary string on every call, and numbers are written
+ * for most moves, so the digits are formatted on the stack instead.
+ *
+ * @returns a BSTR_OK or BSTR_ERR.
+ */
+static int appendnum(jsoncompressinfo *self, int num)
+{
+    char buf[16];
+    int n;
+
+    n = snprintf(buf, sizeof buf, "%d", num);
+    return bcatblk(self->str, buf, n);
+}
+
+/**
+ * Print a mouse click as its offset from Chip: "*." for a click on
+ * Chip himself, otherwise the horizontal and then the vertical part,
+ * separated by ';', e.g. "*3L;D".
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+static int printmouse(jsoncompressinfo *self, int cmd)
+{
+    int x = mousemovex(cmd);
+    int y = mousemovey(cmd);
+    int r = BSTR_OK;
+
+    if (x == 0 && y == 0) {
+	return bcatcstr(self->str, "*.") == BSTR_OK ? 0 : -1;
+    }
+    r = bconchar(self->str, '*');
+    if (r == BSTR_OK && x != 0) {
+	if (x < -1 || x > 1) {
+	    r = appendnum(self, x < 0 ? -x : x);
+	}
+	if (r == BSTR_OK) {
+	    r = bconchar(self->str, x < 0 ? 'L' : 'R');
+	}
+	if (r == BSTR_OK && y != 0) {
+	    r = bconchar(self->str, ';');
+	}
+    }
+    if (r == BSTR_OK && y != 0) {
+	if (y < -1 || y > 1) {
+	    r = appendnum(self, y < 0 ? -y : y);
+	}
+	if (r == BSTR_OK) {
+	    r = bconchar(self->str, y < 0 ? 'U' : 'D');
+	}
+    }
+    return r == BSTR_OK ? 0 : -1;
+}
+
+/**
+ * Print the given direction to the movestring buffer, specialized for
+ * one ruleset. The moves a ruleset never makes, mouse clicks in Lynx
+ * and diagonals in MS, are left to the generic printdir(), so every
+ * variant writes the same movestring; the variants only drop those
+ * tests from the common path. ruleset must be a constant, so that the
+ * tests on it are folded away.
+ *
+ * @param duration 1 or 4
+ * @returns 0 on success. -1 on failure.
+ */
+static inline int printdir_(jsoncompressinfo *self, int dir, int duration,
+			    int ruleset)
+{
+    int r = BSTR_OK;
+
+    if (ruleset != Ruleset_Lynx && duration == 1
+		&& CmdMouseMoveFirst <= dir && dir <= CmdMouseMoveLast) {
+	return printmouse(self, dir);
+    } else if (duration == 1) {
+	switch (dir) {
+	case NORTH: r = bconchar(self->str, 'u'); break;
+	case WEST:  r = bconchar(self->str, 'l'); break;
+	case SOUTH: r = bconchar(self->str, 'd'); break;
+	case EAST:  r = bconchar(self->str, 'r'); break;
+	default: goto other;
+	}
+    } else if (duration == 4) {
+	switch (dir) {
+	case NORTH: r = bconchar(self->str, 'U'); break;
+	case WEST:  r = bconchar(self->str, 'L'); break;
+	case SOUTH: r = bconchar(self->str, 'D'); break;
+	case EAST:  r = bconchar(self->str, 'R'); break;
+	default: goto other;
+	}
+    }
+    return r == BSTR_OK ? 0 : -1;
+
+other:
+    if (ruleset == Ruleset_MS) {
+	return printdir(self, dir, duration);
+    } else if (duration == 1) {
+	switch (dir) {
+	case NORTH|WEST: r = bcatcstr(self->str, "u+l"); break;
+	case NORTH|EAST: r = bcatcstr(self->str, "u+r"); break;
+	case SOUTH|WEST: r = bcatcstr(self->str, "d+l"); break;
+	case SOUTH|EAST: r = bcatcstr(self->str, "d+r"); break;
+	default: goto unknown;
+	}
+    } else {
+	switch (dir) {
+	case NORTH|WEST: r = bcatcstr(self->str, "U+L"); break;
+	case NORTH|EAST: r = bcatcstr(self->str, "U+R"); break;
+	case SOUTH|WEST: r = bcatcstr(self->str, "D+L"); break;
+	case SOUTH|EAST: r = bcatcstr(self->str, "D+R"); break;
+	default: goto unknown;
+	}
+    }
+    return r == BSTR_OK ? 0 : -1;
+
+unknown:
+    if (ruleset != Ruleset_None) {
+	return printdir(self, dir, duration);
+    }
+    errmsg("error", "Unknown direction (%d)", dir);
+    return -1;
+}
+
+int printdir(jsoncompressinfo *self, int dir, int duration)
+{
+    return printdir_(self, dir, duration, Ruleset_None);
+}
+
+int printnum(jsoncompressinfo *self, int num)
+{
+    if (BSTR_OK != appendnum(self, num)) {
+	return -1;
+    }
+    return 0;
+}
+
+int printwait(jsoncompressinfo *self, int count)
+{
+    int r;
+
+    if (count == 0) {
+    } else if (count == 1) {
+	if (BSTR_OK != bconchar(self->str, ',')) {
+	    return -1;
+	}
+    } else if (count == 2) {
+	if (BSTR_OK != bcatcstr(self->str, ",,")) {
+	    return -1;
+	}
+    } else if (count == 4) {
+	if (BSTR_OK != bconchar(self->str, '.')) {
+	    return -1;
+	}
+    } else {
+	r = printnum(self, count);
+	if (r < 0) {
+	    return r;
+	}
+	if (BSTR_OK != bconchar(self->str, ',')) {
+	    return -1;
+	}
+    }
+    return 0;
+}
+
+/**
+ * Reset the state of a jsoncompressinfo struct, leaving its buffer
+ * alone.
+ */
+static void jsoncompress_reset(jsoncompressinfo *self)
+{
+    self->lastmove.dir = NIL;
+
+    self->lastmovedir = NIL;
+    self->lastmoveduration = 0; // 1 or 4.
+
+    self->rlemovedir = NIL;
+    self->rlemoveduration = 0;
+    self->rlecount = 0;
+}
+
+/**
+ * Initialize a jsoncompressinfo struct.
+ */
+int jsoncompress_init(jsoncompressinfo *self)
+{
+    if (self == NULL) {
+	return -1;
+    }
+    jsoncompress_reset(self);
+
+    self->str = bfromcstr("");
+    if (self->str == NULL) {
+	return -1;
+    }
+
+    return 0;
+}
+
+void jsoncompress_free(jsoncompressinfo *self)
+{
+    if (self == NULL) {
+	return;
+    }
+    bdestroy(self->str);
+}
+
+/**
+ * Write the stored move to the buffer.
+ *
+ * Does nothing if no move is stored
+ */
+static inline int jsoncompress_rle_flush_(jsoncompressinfo *self, int ruleset)
+{
+    int r = 0;
+
+    if (self == NULL) {
+	return -1;
+    }
+
+    if (self->rlemovedir != NIL) {
+	if (1 < self->rlecount) {
+	    r = printnum(self, self->rlecount);
+	}
+	if (0 <= r) {
+	    r = printdir_(self, self->rlemovedir, self->rlemoveduration, ruleset);
+	}
+	self->rlemovedir = NIL;
+	self->rlecount = 0;
+    }
+
+    if (r < 0) {
+	return r;
+    }
+
+    return 0;
+}
+
+// Flush means: get rid of any buffered state; flush all moves to the char buffer; we've got something new coming in the pipeline.
+static inline int jsoncompress_flush_(jsoncompressinfo *self, int ruleset)
+{
+    int r = 0;
+
+    r = jsoncompress_rle_flush_(self, ruleset);
+    if (r < 0) {
+	goto cleanup;
+    }
+
+    if (self->lastmovedir != NIL) {
+	r = printdir_(self, self->lastmovedir, self->lastmoveduration, ruleset);
+	if (r < 0) {
+	    goto cleanup;
+	}
+    }
+
+cleanup:
+    self->lastmovedir = NIL;
+    self->lastmoveduration = 0;
+
+    if (r < 0) {
+	return r;
+    }
+
+    return 0;
+}
+
+/**
+ *
+ * If dir and duration differ from the stored dir and duration, the stored move is flushed.
+ *
+ * Does nothing if dir is NIL.
+ */
+static inline int jsoncompress_rle_add_(jsoncompressinfo *self, int dir,
+					 int duration, int ruleset)
+{
+    int r = 0;
+
+    if (self == NULL) {
+	return -1;
+    }
+
+    if (dir == NIL) {
+	return 0;
+    }
+
+    // If the move is the same as the stored move, just update the count.
+    if (self->rlemovedir != NIL) {
+	if (self->rlemovedir == dir && self->rlemoveduration == duration) {
+	    self->rlecount++;
+	    return 0;
+	}
+    }
+
+    // Otherwise, flush the old move and store the new move.
+    r = jsoncompress_rle_flush_(self, ruleset);
+    self->rlemovedir = dir;
+    self->rlemoveduration = duration;
+    self->rlecount = 1;
+    if (r < 0) {
+	return r;
+    }
+
+    return 0;
+}
+
+/**
+ * Add a move to the stream.
+ *
+ * @returns -1 on failure.
+ */
+
+// The algorithm is pretty simple:
+// 1. Expand the incoming stream of actions into a stream of moves.
+// 2. Upconvert to 4-moves whenever possible.
+// 3. RL-encode.
+static inline int jsoncompress_addmove_(jsoncompressinfo *self, action move,
+					 int i, int ruleset)
+{
+    int r;
+    long delta = 1;
+
+    if (self == NULL) {
+	return -1;
+    }
+
+    if (0 < i) {
+	// the ticks between the previous move and the current move.
+	delta = move.when - self->lastmove.when;
+    } else {
+	// count the first move from tick -1, so that any wait before it
+	// is written out.
+	delta = move.when + 1;
+    }
+
+    if (delta <= 0) {
+	errmsg("error", "move %d: bad delta (%d)", i, delta);
+	return -1;
+    }
+
+    // Attempt to upconvert previous move. A mouse click has no
+    // four-tick form.
+    if (self->lastmovedir != NIL && self->lastmoveduration == 1 && 4 <= delta
+				 && directionalcmd(self->lastmovedir)) {
+	self->lastmoveduration = 4;
+	delta -= 3;
+    }
+
+    // We are now finished monkeying with the previous move, so send it along.
+    r = jsoncompress_rle_add_(self, self->lastmovedir, self->lastmoveduration,
+				  ruleset);
+    self->lastmovedir = NIL;
+    if (r < 0) {
+	goto end;
+    }
+
+    // If we have any delta time left, flush the previous move and write it out.
+    if (1 < delta) {
+	r = jsoncompress_flush_(self, ruleset);
+	if (r < 0) {
+	    goto end;
+	}
+	r = printwait(self, delta - 1);
+	if (r < 0) {
+	    goto end;
+	}
+    }
+
+end:
+    self->lastmove = move;
+    self->lastmovedir = move.dir;
+    self->lastmoveduration = 1;
+
+    if (r < 0) {
+	return r;
+    }
+
+    return 0;
+}
+
+/**
+ * Finish the move stream.
+ *
+ * You must supply the total solution time, so appropriate waiting can be added.
+ */
+static inline int jsoncompress_finish_(jsoncompressinfo *self,
+					unsigned long solutiontime, int ruleset)
+{
+    int r;
+
+    if (self == NULL) {
+	return -1;
+    }
+
+    //XXX Attempt to upconvert
+
+    r = jsoncompress_flush_(self, ruleset);
+    if (r < 0) {
+	return r;
+    }
+
+    if (self->lastmove.when < solutiontime) {
+	r = printwait(self, solutiontime - self->lastmove.when - 1);
+	if (r < 0) {
+	    return r;
+	}
+    }
+    return 0;
+}
+
+/**
+ * Convert a list of moves to a textual representation, specialized for
+ * one ruleset. The movestring is written straight into movestr, so a
+ * caller that reuses movestr allocates nothing once it is long enough.
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+static inline int compressjsonsolution_(actlist *moves,
+					unsigned long solutiontime,
+					bstring movestr, int ruleset)
+{
+    jsoncompressinfo jsoncompress;
+    int i, r;
+
+    if (BSTR_OK != btrunc(movestr, 0)) {
+	return -1;
+    }
+    jsoncompress_reset(&jsoncompress);
+    jsoncompress.str = movestr;
+
+    for (i = 0; i < moves->count; i++) {
+	r = jsoncompress_addmove_(&jsoncompress, moves->list[i], i, ruleset);
+	if (r < 0) {
+	    return r;
+	}
+    }
+    return jsoncompress_finish_(&jsoncompress, solutiontime, ruleset);
+}
+
+/*
+ * The generic encoder, which makes no assumption about the ruleset.
+ */
+
+int jsoncompress_flush(jsoncompressinfo *self)
+{
+    return jsoncompress_flush_(self, Ruleset_None);
+}
+
+int jsoncompress_rle_add(jsoncompressinfo *self, int dir, int duration)
+{
+    return jsoncompress_rle_add_(self, dir, duration, Ruleset_None);
+}
+
+int jsoncompress_rle_flush(jsoncompressinfo *self)
+{
+    return jsoncompress_rle_flush_(self, Ruleset_None);
+}
+
+int jsoncompress_addmove(jsoncompressinfo *self, action move, int i)
+{
+    return jsoncompress_addmove_(self, move, i, Ruleset_None);
+}
+
+int jsoncompress_finish(jsoncompressinfo *self, unsigned long solutiontime)
+{
+    return jsoncompress_finish_(self, solutiontime, Ruleset_None);
+}
+
+int compressjsonsolution(actlist *moves, unsigned long solutiontime, bstring movestr)
+{
+    return compressjsonsolution_(moves, solutiontime, movestr, Ruleset_None);
+}
+
+/*
+ * The encoders specialized for each ruleset.
+ */
+
+static int compressjsonsolution_lynx(actlist *moves, unsigned long solutiontime,
+				     bstring movestr)
+{
+    return compressjsonsolution_(moves, solutiontime, movestr, Ruleset_Lynx);
+}
+
+static int compressjsonsolution_ms(actlist *moves, unsigned long solutiontime,
+				   bstring movestr)
+{
+    return compressjsonsolution_(moves, solutiontime, movestr, Ruleset_MS);
+}
+
+compressjsonfunc compressjsonsolution_for(int ruleset)
+{
+    switch (ruleset) {
+    case Ruleset_Lynx: return compressjsonsolution_lynx;
+    case Ruleset_MS:   return compressjsonsolution_ms;
+    default:           return compressjsonsolution;
+    }
+}
@@ -0,0 +1,56 @@
+/* jsoncompress.h: Converting lists of moves to movestrings.
+ *
+ * Copyright © 2011 by Andrew Ekstedt, under the GNU General Public
+ * License. No warranty. See COPYING for details.
+ */
+
+#ifndef _jsoncompress_h_
+#define _jsoncompress_h_
+
+#include "bstrlib.h"
+#include "solution.h"
+
+typedef struct jsoncompressinfo {
+    bstring	str;
+
+    action	lastmove;
+
+    int	lastmovedir;
+    int	lastmoveduration;
+
+    int	rlemovedir;
+    int	rlemoveduration;
+    int	rlecount;
+} jsoncompressinfo;
+
+int jsoncompress_init(jsoncompressinfo *self);
+void jsoncompress_free(jsoncompressinfo *self);
+int jsoncompress_flush(jsoncompressinfo *self);
+int jsoncompress_finish(jsoncompressinfo *self, unsigned long solutiontime);
+int jsoncompress_addmove(jsoncompressinfo *self, action move, int i);
+int jsoncompress_rle_add(jsoncompressinfo *self, int dir, int duration);
+int jsoncompress_rle_flush(jsoncompressinfo *self);
+
+int printdir(jsoncompressinfo *self, int dir, int duration);
+int printnum(jsoncompressinfo *self, int num);
+int printwait(jsoncompressinfo *self, int count);
+
+/**
+ * Convert a list of moves to a textual representation.
+ *
+ * @returns 0 on success. -1 on failure.
+ */
+int compressjsonsolution(actlist *moves, unsigned long solutiontime, bstring movestr);
+
+typedef int (*compressjsonfunc)(actlist *moves, unsigned long solutiontime,
+				bstring movestr);
+
+/**
+ * Return the variant of compressjsonsolution() specialized for the
+ * given ruleset, or compressjsonsolution() itself if there is none.
+ * Every variant gives the same movestring for any list of moves; they
+ * are only faster on the moves their ruleset can make.
+ */
+compressjsonfunc compressjsonsolution_for(int ruleset);
+
+#endif
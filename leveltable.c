@@ -0,0 +1,103 @@
+/* leveltable.c: A hash table of per-level entries keyed by level number.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdlib.h>
+#include	<string.h>
+#include	"err.h"
+#include	"leveltable.h"
+
+#define	levelhash(number)	((unsigned)(number) * 2654435761U)
+
+/* The slot at the given index, and its level number.
+ */
+#define	slotat(table, i)	((char*)(table)->slots + (size_t)(i) * (table)->size)
+#define	slotnumber(slot)	(*(int const*)(slot))
+
+/* Return the slot for the given level, which is empty if the level
+ * is not in the table.
+ */
+static void *findlevel(leveltable *table, int number)
+{
+    unsigned	i;
+
+    i = levelhash(number) & (table->allocated - 1);
+    while (slotnumber(slotat(table, i))
+			&& slotnumber(slotat(table, i)) != number)
+	i = (i + 1) & (table->allocated - 1);
+    return slotat(table, i);
+}
+
+/* Double the size of the table.
+ */
+static void growleveltable(leveltable *table)
+{
+    leveltable	old = *table;
+    int		i;
+
+    table->allocated = old.allocated ? old.allocated * 2 : 64;
+    table->slots = NULL;
+    xalloc(table->slots, table->allocated * table->size);
+    memset(table->slots, 0, table->allocated * table->size);
+    for (i = 0 ; i < old.allocated ; ++i)
+	if (slotnumber(slotat(&old, i)))
+	    memcpy(findlevel(table, slotnumber(slotat(&old, i))),
+		   slotat(&old, i), table->size);
+    free(old.slots);
+}
+
+void leveltable_init(leveltable *table, size_t size)
+{
+    table->allocated = 0;
+    table->count = 0;
+    table->size = size;
+    table->slots = NULL;
+    growleveltable(table);
+}
+
+void *leveltable_add(leveltable *table, int number, int *added)
+{
+    void       *slot;
+    int		isnew;
+
+    if (2 * (table->count + 1) > table->allocated)
+	growleveltable(table);
+    slot = findlevel(table, number);
+    isnew = !slotnumber(slot);
+    if (isnew) {
+	*(int*)slot = number;
+	++table->count;
+    }
+    if (added)
+	*added = isnew;
+    return slot;
+}
+
+static int cmplevels(void const *a, void const *b)
+{
+    return slotnumber(a) - slotnumber(b);
+}
+
+int leveltable_sort(leveltable *table)
+{
+    int	i, n;
+
+    for (i = n = 0 ; i < table->allocated ; ++i)
+	if (slotnumber(slotat(table, i))) {
+	    if (i != n)
+		memcpy(slotat(table, n), slotat(table, i), table->size);
+	    ++n;
+	}
+    qsort(table->slots, n, table->size, cmplevels);
+    return n;
+}
+
+void leveltable_free(leveltable *table)
+{
+    free(table->slots);
+    table->slots = NULL;
+    table->allocated = 0;
+    table->count = 0;
+}
@@ -0,0 +1,45 @@
+/* leveltable.h: A hash table of per-level entries keyed by level number.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_leveltable_h_
+#define	_leveltable_h_
+
+#include	<stddef.h>
+
+/* An open-addressing hash table holding one entry per level. The
+ * entries are structs of the caller's choosing, all of the same size,
+ * whose first member is the int level number; a number of zero marks
+ * an empty slot.
+ */
+typedef struct leveltable {
+    int			allocated;	/* number of slots (a power of two) */
+    int			count;		/* number of slots in use */
+    size_t		size;		/* size of one entry */
+    void	       *slots;		/* the entries */
+} leveltable;
+
+/* Create an empty table of entries of the given size.
+ */
+extern void leveltable_init(leveltable *table, size_t size);
+
+/* Return the entry for the given level, adding it to the table if it
+ * is not there yet. A new entry is zeroed apart from its number, and
+ * added, if it is not NULL, is set to TRUE if the entry is new and to
+ * FALSE otherwise. The table may grow, which moves every entry.
+ */
+extern void *leveltable_add(leveltable *table, int number, int *added);
+
+/* Move the entries in use to the front of the slots, in order of
+ * level number, and return how many there are. Nothing can be added
+ * to the table afterwards.
+ */
+extern int leveltable_sort(leveltable *table);
+
+/* Free the slots of the table.
+ */
+extern void leveltable_free(leveltable *table);
+
+#endif
@@ -0,0 +1,129 @@
+/* merge.c: Merging the best solutions from several TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	"err.h"
+#include	"fileio.h"
+#include	"solution.h"
+#include	"leveltable.h"
+#include	"merge.h"
+
+/* Offer a record to the table, which holds the best record seen so
+ * far for each level. The table takes over the record's data if it is
+ * the best so far; otherwise the data is freed. The table holds one
+ * entry per level, so its size depends on the number of levels and
+ * not on how many files, or how large, are merged.
+ */
+static void offerlevel(leveltable *map, gamesetup *game)
+{
+    gamesetup  *slot;
+    int		added;
+
+    slot = leveltable_add(map, game->number, &added);
+    if (!added && (game->solutionsize <= 16
+		   || (slot->solutionsize > 16
+				&& slot->besttime <= game->besttime))) {
+	clearsolution(game);
+	return;
+    }
+    clearsolution(slot);
+    *slot = *game;
+    game->solutiondata = NULL;
+    game->solutionsize = 0;
+}
+
+/* Read one file into the table.
+ */
+static int readfile(leveltable *map, char const *name, int *ruleset,
+		    int *currentlevel, char *setname)
+{
+    fileinfo		file;
+    gamesetup		game;
+    unsigned char	extra[256];
+    int			r, level, extrasize;
+    int			ok = TRUE;
+
+    clearfileinfo(&file);
+    if (!fileopen(&file, name, "rb", "file error"))
+	return FALSE;
+    if (!readsolutionheader(&file, &r, &level, &extrasize, extra)) {
+	fileclose(&file, NULL);
+	return FALSE;
+    }
+    if (*ruleset && r != *ruleset) {
+	errmsg(name, "ruleset does not match the other files");
+	fileclose(&file, NULL);
+	return FALSE;
+    }
+    *ruleset = r;
+    if (!*currentlevel)
+	*currentlevel = level;
+
+    memset(&game, 0, sizeof game);
+    while (!filetestend(&file)) {
+	if (!readsolution(&file, &game)) {
+	    ok = FALSE;
+	    break;
+	}
+	if (game.sgflags & SGF_SETNAME) {
+	    if (!*setname) {
+		strcpy(setname, game.name);
+	    } else if (strcmp(setname, game.name)) {
+		errmsg(name, "levelset %s does not match %s",
+		       game.name, setname);
+		ok = FALSE;
+		break;
+	    }
+	}
+	if (game.number)
+	    offerlevel(map, &game);
+	clearsolution(&game);
+    }
+    clearsolution(&game);
+    fileclose(&file, NULL);
+    return ok;
+}
+
+/* Merge the named files into outname.
+ */
+int mergefiles(char const *outname, char **names, int count)
+{
+    leveltable	map;
+    gamesetup  *slots;
+    fileinfo	out;
+    char	setname[256] = "";
+    int		ruleset = Ruleset_None, currentlevel = 0;
+    int		i, n, ok = TRUE;
+
+    leveltable_init(&map, sizeof(gamesetup));
+    for (i = 0 ; ok && i < count ; ++i)
+	ok = readfile(&map, names[i], &ruleset, &currentlevel, setname);
+
+    slots = map.slots;
+    if (ok) {
+	n = leveltable_sort(&map);
+
+	clearfileinfo(&out);
+	ok = fileopen(&out, outname, "wb", "file error")
+		&& writesolutionheader(&out, ruleset, currentlevel, 0, NULL)
+		&& (!*setname || writesolutionsetname(&out, setname));
+	for (i = 0 ; ok && i < n ; ++i)
+	    ok = writesolution(&out, &slots[i]);
+	for (i = 0 ; i < n ; ++i)
+	    clearsolution(&slots[i]);
+	if (out.fp && fflush(out.fp))
+	    ok = fileerr(&out, "write error");
+	fileclose(&out, "write error");
+    } else {
+	for (i = 0 ; i < map.allocated ; ++i)
+	    clearsolution(&slots[i]);
+    }
+
+    leveltable_free(&map);
+    return ok ? 0 : -1;
+}
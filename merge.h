@@ -0,0 +1,19 @@
+/* merge.h: Merging the best solutions from several TWS files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_merge_h_
+#define	_merge_h_
+
+/* Read every named TWS file and write a file to outname holding, for
+ * each level, the solution with the lowest besttime. Ties go to the
+ * file named first. A level for which no file has a solution keeps
+ * its password. All of the files must use the same ruleset. The
+ * inputs are all read before the output is opened, so outname can be
+ * one of them. The return value is negative on failure.
+ */
+extern int mergefiles(char const *outname, char **names, int count);
+
+#endif
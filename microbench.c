@@ -0,0 +1,229 @@
+/* microbench.c: Time the primitives of the movestring encoder.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+
+#include "solution.h"
+#include "jsoncompress.h"
+#include "err.h"
+
+/* The number of moves in each pattern.
+ */
+#define PATTERNSIZE (1 << 16)
+
+/* A list of moves made to stress one aspect of the encoder.
+ */
+typedef struct pattern {
+    char const	       *name;
+    int			duration;	/* 1 or 4, as passed to printdir() */
+    action		moves[PATTERNSIZE];
+} pattern;
+
+/* A primitive under test, applied to every move of a pattern.
+ */
+typedef struct primitive {
+    char const	       *name;
+    int		      (*run)(jsoncompressinfo*, pattern const*);
+} primitive;
+
+static double now(void)
+{
+    struct timespec	ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int const orthogonal[4] = { NORTH, WEST, SOUTH, EAST };
+static int const diagonal[4] = {
+    NORTH | WEST, SOUTH | WEST, SOUTH | EAST, NORTH | EAST
+};
+
+/* Fill in the moves of a pattern. Every move in a pattern has the
+ * same spacing, so the encoder sees the same case over and over.
+ */
+static void makepattern(pattern *p, char const *name)
+{
+    int	i, spacing, dir;
+
+    p->name = name;
+    p->duration = 1;
+    for (i = 0 ; i < PATTERNSIZE ; ++i) {
+	if (!strcmp(name, "1tick")) {
+	    // One long run of the same quick move.
+	    spacing = 1;
+	    dir = WEST;
+	} else if (!strcmp(name, "4tick")) {
+	    // One long run of the same full-length move.
+	    spacing = 4;
+	    dir = WEST;
+	    p->duration = 4;
+	} else if (!strcmp(name, "alternating")) {
+	    // Quick moves that never repeat, so nothing can be merged.
+	    spacing = 1;
+	    dir = orthogonal[i & 3];
+	} else if (!strcmp(name, "longwait")) {
+	    // Every move is followed by a wait with a long count.
+	    spacing = 100;
+	    dir = orthogonal[i & 3];
+	} else {
+	    // Diagonal moves, which are the longest to write.
+	    spacing = 4;
+	    dir = diagonal[i & 3];
+	    p->duration = 4;
+	}
+	p->moves[i].when = i * spacing;
+	p->moves[i].dir = dir;
+    }
+}
+
+static int runprintdir(jsoncompressinfo *self, pattern const *p)
+{
+    int	i;
+
+    for (i = 0 ; i < PATTERNSIZE ; ++i)
+	if (printdir(self, p->moves[i].dir, p->duration) < 0)
+	    return FALSE;
+    return TRUE;
+}
+
+static int runprintwait(jsoncompressinfo *self, pattern const *p)
+{
+    int	i;
+
+    for (i = 1 ; i < PATTERNSIZE ; ++i)
+	if (printwait(self, p->moves[i].when - p->moves[i - 1].when - 1) < 0)
+	    return FALSE;
+    return TRUE;
+}
+
+static int runprintnum(jsoncompressinfo *self, pattern const *p)
+{
+    int	i;
+
+    for (i = 0 ; i < PATTERNSIZE ; ++i)
+	if (printnum(self, p->moves[i].when) < 0)
+	    return FALSE;
+    return TRUE;
+}
+
+static int runrleadd(jsoncompressinfo *self, pattern const *p)
+{
+    int	i;
+
+    for (i = 0 ; i < PATTERNSIZE ; ++i)
+	if (jsoncompress_rle_add(self, p->moves[i].dir, p->duration) < 0)
+	    return FALSE;
+    return jsoncompress_rle_flush(self) == 0;
+}
+
+static int runaddmove(jsoncompressinfo *self, pattern const *p)
+{
+    int	i;
+
+    for (i = 0 ; i < PATTERNSIZE ; ++i)
+	if (jsoncompress_addmove(self, p->moves[i], i) < 0)
+	    return FALSE;
+    return jsoncompress_flush(self) == 0;
+}
+
+/* Time one primitive on one pattern for at least mintime seconds, and
+ * return the fastest run in nanoseconds per move, or a negative value
+ * if the primitive failed.
+ */
+static double timeprimitive(primitive const *prim, pattern const *p,
+			    double mintime)
+{
+    jsoncompressinfo	self;
+    double		start, t0, t, best = 0;
+    int			n = 0;
+
+    if (jsoncompress_init(&self) < 0)
+	memerrexit();
+    start = now();
+    do {
+	jsoncompress_free(&self);
+	if (jsoncompress_init(&self) < 0)
+	    memerrexit();
+	t0 = now();
+	if (!(*prim->run)(&self, p)) {
+	    jsoncompress_free(&self);
+	    return -1;
+	}
+	t = now() - t0;
+	if (!n || t < best)
+	    best = t;
+	++n;
+    } while (now() - start < mintime);
+    jsoncompress_free(&self);
+    return best * 1e9 / PATTERNSIZE;
+}
+
+static void usage(FILE *fp)
+{
+    fprintf(fp, "usage: microbench [-t seconds]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static char const *const patterns[] = {
+		"1tick", "4tick", "alternating", "longwait", "diagonal",
+	};
+	static primitive const primitives[] = {
+		{ "printdir", runprintdir },
+		{ "printwait", runprintwait },
+		{ "printnum", runprintnum },
+		{ "jsoncompress_rle_add", runrleadd },
+		{ "jsoncompress_addmove", runaddmove },
+	};
+	pattern *p;
+	double mintime = 0.2;
+	double ns;
+	int ch, i, j, r = 0;
+
+	while ((ch = getopt(argc, argv, "t:h")) != -1) {
+		switch (ch) {
+		case 't':
+			mintime = atof(optarg);
+			break;
+		case 'h':
+			usage(stdout);
+			return 0;
+		default:
+			usage(stderr);
+			return 1;
+		}
+	}
+
+	p = malloc(sizeof *p);
+	if (p == NULL) {
+		memerrexit();
+	}
+	for (i = 0; i < (int)(sizeof patterns / sizeof *patterns); i++) {
+		makepattern(p, patterns[i]);
+		for (j = 0; j < (int)(sizeof primitives / sizeof *primitives); j++) {
+			ns = timeprimitive(&primitives[j], p, mintime);
+			if (ns < 0) {
+				errmsg(primitives[j].name, "failed on pattern %s",
+				       p->name);
+				r = 1;
+				continue;
+			}
+			printf("{\"function\":\"%s\",\"pattern\":\"%s\","
+			       "\"moves\":%d,\"ns_per_move\":%.2f}\n",
+			       primitives[j].name, p->name, PATTERNSIZE, ns);
+			fflush(stdout);
+		}
+	}
+	free(p);
+	return r;
+}
@@ -0,0 +1,260 @@
+/* movestr.c: Parsing movestrings.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<stdint.h>
+#include	"err.h"
+#include	"solution.h"
+#include	"movestr.h"
+
+/* The lexer classifies every character with a single table lookup.
+ * The low three bits of an entry hold the class, bit 3 is set for the
+ * four-tick forms (uppercase letters and '.'), and the top four bits
+ * hold the direction of a move letter.
+ */
+#define	CC_BAD		0
+#define	CC_SPACE	1
+#define	CC_DIGIT	2
+#define	CC_WAIT		3
+#define	CC_MOVE		4
+#define	CC_MOUSE	5
+#define	CC_PLUS		6
+#define	CC_SEMI		7
+
+#define	CC_LONG		0x08
+
+#define	ccclass(cc)	((cc) & 7)
+#define	ccduration(cc)	((cc) & CC_LONG ? 4 : 1)
+#define	ccdir(cc)	((cc) >> 4)
+
+static unsigned char const charclass[256] = {
+    [' '] = CC_SPACE,
+    ['0'] = CC_DIGIT, ['1'] = CC_DIGIT, ['2'] = CC_DIGIT, ['3'] = CC_DIGIT,
+    ['4'] = CC_DIGIT, ['5'] = CC_DIGIT, ['6'] = CC_DIGIT, ['7'] = CC_DIGIT,
+    ['8'] = CC_DIGIT, ['9'] = CC_DIGIT,
+    [','] = CC_WAIT,
+    ['.'] = CC_WAIT | CC_LONG,
+    ['u'] = CC_MOVE | (NORTH << 4),
+    ['l'] = CC_MOVE | (WEST << 4),
+    ['d'] = CC_MOVE | (SOUTH << 4),
+    ['r'] = CC_MOVE | (EAST << 4),
+    ['U'] = CC_MOVE | CC_LONG | (NORTH << 4),
+    ['L'] = CC_MOVE | CC_LONG | (WEST << 4),
+    ['D'] = CC_MOVE | CC_LONG | (SOUTH << 4),
+    ['R'] = CC_MOVE | CC_LONG | (EAST << 4),
+    ['*'] = CC_MOUSE,
+    ['+'] = CC_PLUS,
+    [';'] = CC_SEMI
+};
+
+#define	isvertical(dir)	(((dir) & (NORTH | SOUTH)) != 0)
+
+/* Return the number of characters, starting at p and ending before
+ * end, that are equal to *p. Eight characters are compared at a time
+ * while there is room, so long runs of waits, spaces, or identical
+ * moves cost one step per word instead of one per character.
+ */
+static size_t runlength(char const *p, char const *end)
+{
+    char const *q = p + 1;
+    uint64_t	pattern, word, diff;
+
+    pattern = (unsigned char)*p * UINT64_C(0x0101010101010101);
+    while (end - q >= 8) {
+	memcpy(&word, q, 8);
+	diff = word ^ pattern;
+	if (diff) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	    return q - p + (__builtin_ctzll(diff) >> 3);
+#else
+	    return q - p + (__builtin_clzll(diff) >> 3);
+#endif
+	}
+	q += 8;
+    }
+    while (q < end && *q == *p)
+	++q;
+    return q - p;
+}
+
+/* Read a repeat count. The one- and two-digit counts that make up
+ * nearly all of them are handled without looping.
+ */
+static char const *readcount(char const *p, unsigned long *count)
+{
+    if (ccclass(charclass[(unsigned char)p[1]]) != CC_DIGIT) {
+	*count = p[0] - '0';
+	return p + 1;
+    }
+    if (ccclass(charclass[(unsigned char)p[2]]) != CC_DIGIT) {
+	*count = (p[0] - '0') * 10 + (p[1] - '0');
+	return p + 2;
+    }
+    *count = 0;
+    while (ccclass(charclass[(unsigned char)*p]) == CC_DIGIT) {
+	*count = *count * 10 + (*p - '0');
+	if (*count > MAXIMUM_TICK_COUNT)
+	    *count = MAXIMUM_TICK_COUNT + 1;
+	++p;
+    }
+    return p;
+}
+
+/* Parse the target of a mouse click (the part after the '*').
+ */
+static char const *readmousemove(char const *p, int *cmd)
+{
+    unsigned long	count;
+    int			x = 0, y = 0;
+    int			cc, dir;
+
+    if (*p == '.') {
+	*cmd = CmdMoveNop;
+	return p + 1;
+    }
+    for (;;) {
+	count = 1;
+	if (ccclass(charclass[(unsigned char)*p]) == CC_DIGIT)
+	    p = readcount(p, &count);
+	cc = charclass[(unsigned char)*p];
+	if (ccclass(cc) != CC_MOVE || count > MOUSERANGEMAX)
+	    return NULL;
+	dir = ccdir(cc);
+	if (dir == NORTH)
+	    y -= count;
+	else if (dir == SOUTH)
+	    y += count;
+	else if (dir == WEST)
+	    x -= count;
+	else
+	    x += count;
+	++p;
+	if (ccclass(charclass[(unsigned char)*p]) != CC_SEMI)
+	    break;
+	++p;
+    }
+    if (x < MOUSERANGEMIN || x > MOUSERANGEMAX
+		|| y < MOUSERANGEMIN || y > MOUSERANGEMAX)
+	return NULL;
+    *cmd = mousemovecmd(x, y);
+    return p;
+}
+
+/* Parse a movestring into a list of moves.
+ */
+int parsemovestring(char const *str, actlist *moves,
+		    unsigned long *solutiontime)
+{
+    char const	       *p, *q, *end;
+    unsigned long	when, count, i;
+    action		act;
+    int			cc, cc2, dir, duration, hascount;
+    int			endsinmove = FALSE;
+
+    initmovelist(moves);
+    when = 0;
+    p = str;
+    end = str + strlen(str);
+    while (p < end) {
+	cc = charclass[(unsigned char)*p];
+	count = 1;
+	hascount = ccclass(cc) == CC_DIGIT;
+	if (hascount) {
+	    p = readcount(p, &count);
+	    cc = charclass[(unsigned char)*p];
+	}
+	switch (ccclass(cc)) {
+	  case CC_SPACE:
+	    if (hascount)
+		goto badchar;
+	    p += runlength(p, end);
+	    continue;
+	  case CC_WAIT:
+	    if (!hascount) {
+		count = runlength(p, end);
+		p += count;
+	    } else {
+		++p;
+	    }
+	    dir = NIL;
+	    duration = ccduration(cc);
+	    break;
+	  case CC_MOVE:
+	    dir = ccdir(cc);
+	    duration = ccduration(cc);
+	    if (!hascount && p[1] == *p) {
+		// A run of identical letters, less any letter which
+		// starts a diagonal.
+		count = runlength(p, end);
+		if (ccclass(charclass[(unsigned char)p[count]]) == CC_PLUS)
+		    --count;
+		p += count;
+		break;
+	    }
+	    ++p;
+	    if (ccclass(charclass[(unsigned char)*p]) == CC_PLUS) {
+		cc2 = charclass[(unsigned char)p[1]];
+		if (ccclass(cc2) != CC_MOVE
+				|| ccduration(cc2) != duration
+				|| isvertical(ccdir(cc2)) == isvertical(dir)) {
+		    ++p;
+		    goto badchar;
+		}
+		dir |= ccdir(cc2);
+		p += 2;
+	    }
+	    break;
+	  case CC_MOUSE:
+	    q = readmousemove(p + 1, &dir);
+	    if (!q) {
+		errmsg("movestring", "bad mouse move at offset %d",
+		       (int)(p - str));
+		return FALSE;
+	    }
+	    p = q;
+	    duration = 1;
+	    break;
+	  default:
+	    goto badchar;
+	}
+
+	if (count * duration > MAXIMUM_TICK_COUNT - when) {
+	    errmsg("movestring", "solution is too long");
+	    return FALSE;
+	}
+	if (dir == NIL) {
+	    when += count * duration;
+	    endsinmove = FALSE;
+	    continue;
+	}
+	act.dir = dir;
+	for (i = 0 ; i < count ; ++i) {
+	    act.when = when;
+	    addtomovelist(moves, act);
+	    when += duration;
+	}
+	// A four-tick move includes its three waits, as format.txt has
+	// L equal to l3, so only a one-tick move can end the solution.
+	endsinmove = count > 0 && duration == 1;
+    }
+    // jsoncompress_finish() writes no trailing wait when the solution
+    // ends on the tick of its final move.
+    if (endsinmove)
+	*solutiontime = moves->list[moves->count - 1].when;
+    else
+	*solutiontime = when;
+    return TRUE;
+
+  badchar:
+    if (p < end)
+	errmsg("movestring", "unexpected character '%c' at offset %d",
+	       *p, (int)(p - str));
+    else
+	errmsg("movestring", "unexpected end of string");
+    return FALSE;
+}
@@ -0,0 +1,22 @@
+/* movestr.h: Parsing movestrings.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_movestr_h_
+#define	_movestr_h_
+
+#include	"solution.h"
+
+/* Parse a movestring, as described in format.txt, into a list of
+ * moves. The string starts at tick zero.
+ * solutiontime receives the tick at which the movestring ends, or the
+ * tick of the final move if the string ends with a one-tick move.
+ * FALSE is returned, and an error is displayed, if the string is
+ * invalid.
+ */
+extern int parsemovestring(char const *str, actlist *moves,
+			   unsigned long *solutiontime);
+
+#endif
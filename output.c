@@ -0,0 +1,303 @@
+/* output.c: Writing converted solution files.
+ *
+ * Copyright © 2011 by Andrew Ekstedt, and © 2026 by the tws2json
+ * contributors, under the GNU General Public License. No warranty.
+ * See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<inttypes.h>
+#include	"solution.h"
+#include	"cbor.h"
+#include	"columnar.h"
+#include	"isa.h"
+#include	"output.h"
+#include	"version.h"
+
+static char const *ruleset_names[] = {
+    "",
+    "lynx", /* Ruleset_Lynx */
+    "ms", /* Ruleset_MS */
+};
+
+/* The punctuation separating the parts of a JSON document. The
+ * pretty style puts every field on a line of its own; the compact
+ * style has no insignificant whitespace at all.
+ */
+typedef struct jsonstyle {
+    char const *docopen;	/* before the first header field */
+    char const *docsep;		/* between header fields */
+    char const *listopen;	/* after "solutions": */
+    char const *itemopen;	/* before each solution object */
+    char const *itemsep;	/* between fields of a solution */
+    char const *listsep;	/* between solution objects */
+    char const *docclose;	/* after the last solution */
+} jsonstyle;
+
+static jsonstyle const prettystyle = {
+    "{", ",\n ", "[\n", "  {", ",\n   ", ",\n", "\n]}\n"
+};
+
+static jsonstyle const compactstyle = {
+    "{", ",", "[", "{", ",", ",", "]}\n"
+};
+
+/* The style used for a JSON document in the given format.
+ */
+#define	docstyle(format)	\
+    ((format) == Output_CompactJSON ? &compactstyle : &prettystyle)
+
+/* Write the contents of a JSON string, escaping the characters that
+ * need it. Level set names are taken from the file as they are, so
+ * they may contain quotes.
+ */
+static void writejsonstr(FILE *fp, char const *str)
+{
+    size_t	n;
+
+    for (;;) {
+	n = jsonscan(str);
+	fwrite(str, 1, n, fp);
+	str += n;
+	switch (*str) {
+	  case '\0':	return;
+	  case '"':	fputs("\\\"", fp);			break;
+	  case '\\':	fputs("\\\\", fp);			break;
+	  case '\n':	fputs("\\n", fp);			break;
+	  case '\t':	fputs("\\t", fp);			break;
+	  default:	fprintf(fp, "\\u%04x", (unsigned char)*str);	break;
+	}
+	++str;
+    }
+}
+
+/* Prepare to write a document in the given format to fp.
+ */
+void output_init(outputinfo *out, FILE *fp, int format)
+{
+    out->fp = fp;
+    out->format = format;
+    out->count = 0;
+    out->ruleset = Ruleset_None;
+    out->levelset[0] = '\0';
+    out->columns = NULL;
+}
+
+/* Write the header fields shared by the JSON and NDJSON formats.
+ */
+static void writeheaderfields(outputinfo *out, jsonstyle const *style,
+			      int currentlevel)
+{
+    fprintf(out->fp, "%s\"class\":\"tws\"", style->docopen);
+    fprintf(out->fp, "%s\"ruleset\":\"%s\"",
+		     style->docsep, ruleset_names[out->ruleset]);
+    if (currentlevel != 0)
+	fprintf(out->fp, "%s\"currentlevel\":%d", style->docsep, currentlevel);
+    if (*out->levelset) {
+	fprintf(out->fp, "%s\"levelset\":\"", style->docsep);
+	writejsonstr(out->fp, out->levelset);
+	fputc('"', out->fp);
+    }
+    fprintf(out->fp, "%s\"generator\":\"tws2json/" VERSION "\"",
+		     style->docsep);
+}
+
+/* Write the document header as the start of a CBOR map. The
+ * solutions array is left open, as its length is not yet known.
+ */
+static void writecborheader(outputinfo *out, int currentlevel)
+{
+    FILE       *fp = out->fp;
+
+    cbor_putmap(fp, 4 + (currentlevel != 0) + (*out->levelset != '\0'));
+    cbor_putcstr(fp, "class");
+    cbor_putcstr(fp, "tws");
+    cbor_putcstr(fp, "ruleset");
+    cbor_putcstr(fp, ruleset_names[out->ruleset]);
+    if (currentlevel != 0) {
+	cbor_putcstr(fp, "currentlevel");
+	cbor_putuint(fp, currentlevel);
+    }
+    if (*out->levelset) {
+	cbor_putcstr(fp, "levelset");
+	cbor_putcstr(fp, out->levelset);
+    }
+    cbor_putcstr(fp, "generator");
+    cbor_putcstr(fp, "tws2json/" VERSION);
+    cbor_putcstr(fp, "solutions");
+    cbor_putarraystart(fp);
+}
+
+/* Write the document header.
+ */
+int output_begin(outputinfo *out, int ruleset, int currentlevel,
+		 char const *levelset)
+{
+    jsonstyle const    *style;
+
+    out->ruleset = ruleset;
+    if (levelset) {
+	strncpy(out->levelset, levelset, sizeof out->levelset - 1);
+	out->levelset[sizeof out->levelset - 1] = '\0';
+    } else {
+	out->levelset[0] = '\0';
+    }
+
+    switch (out->format) {
+      case Output_JSON:
+      case Output_CompactJSON:
+	style = docstyle(out->format);
+	writeheaderfields(out, style, currentlevel);
+	fprintf(out->fp, "%s\"solutions\":%s", style->docsep, style->listopen);
+	break;
+      case Output_NDJSON:
+	writeheaderfields(out, &compactstyle, currentlevel);
+	fputs("}\n", out->fp);
+	break;
+      case Output_Columnar:
+	out->columns = columnar_new(ruleset, levelset);
+	break;
+      case Output_CBOR:
+	writecborheader(out, currentlevel);
+	break;
+    }
+    return ferror(out->fp) ? -1 : 0;
+}
+
+/* Write the fields of one solution object.
+ */
+static void writesolutionfields(outputinfo *out, jsonstyle const *style,
+				gamesetup const *game, recordinfo const *record,
+				solutioninfo const *solution, char const *moves)
+{
+    char const *sep = style->itemsep;
+
+    fprintf(out->fp, "%s\"number\":%u", sep, game->number);
+    if (record) {
+	if (record->offset >= 0)
+	    fprintf(out->fp, "%s\"offset\":%ld", sep, record->offset);
+	fprintf(out->fp, "%s\"solutionsize\":%lu", sep, record->size);
+	fprintf(out->fp, "%s\"hash\":\"%016" PRIx64 "\"", sep, record->hash);
+    }
+    if (!solution) {
+	fprintf(out->fp, "%s\"password\":\"%.4s\"}", sep, game->passwd);
+	return;
+    }
+    fprintf(out->fp, "%s\"password\":\"%s\"", sep, game->passwd);
+    fprintf(out->fp, "%s\"rndslidedir\":%d", sep, (int)solution->rndslidedir);
+    fprintf(out->fp, "%s\"stepping\":%d", sep, (int)solution->stepping);
+    fprintf(out->fp, "%s\"rndseed\":%lu", sep, solution->rndseed);
+    fprintf(out->fp, "%s\"moves\":\"%s\"}", sep, moves);
+}
+
+/* Write one solution as a CBOR map.
+ */
+static void writecborsolution(outputinfo *out, gamesetup const *game,
+			      recordinfo const *record,
+			      solutioninfo const *solution, char const *moves)
+{
+    FILE       *fp = out->fp;
+    char	hash[17];
+    int		fields = solution ? 7 : 3;
+
+    if (record)
+	fields += 2 + (record->offset >= 0);
+    cbor_putmap(fp, fields);
+    cbor_putcstr(fp, "class");
+    cbor_putcstr(fp, "solution");
+    cbor_putcstr(fp, "number");
+    cbor_putuint(fp, game->number);
+    if (record) {
+	if (record->offset >= 0) {
+	    cbor_putcstr(fp, "offset");
+	    cbor_putuint(fp, record->offset);
+	}
+	cbor_putcstr(fp, "solutionsize");
+	cbor_putuint(fp, record->size);
+	sprintf(hash, "%016" PRIx64, record->hash);
+	cbor_putcstr(fp, "hash");
+	cbor_putcstr(fp, hash);
+    }
+    cbor_putcstr(fp, "password");
+    cbor_puttext(fp, game->passwd, strnlen(game->passwd, 4));
+    if (!solution)
+	return;
+    cbor_putcstr(fp, "rndslidedir");
+    cbor_putuint(fp, solution->rndslidedir);
+    cbor_putcstr(fp, "stepping");
+    cbor_putuint(fp, solution->stepping);
+    cbor_putcstr(fp, "rndseed");
+    cbor_putuint(fp, solution->rndseed);
+    cbor_putcstr(fp, "moves");
+    cbor_putcstr(fp, moves);
+}
+
+/* Write one solution.
+ */
+int output_solution(outputinfo *out, gamesetup const *game,
+		    recordinfo const *record,
+		    solutioninfo const *solution, char const *moves)
+{
+    jsonstyle const    *style;
+
+    switch (out->format) {
+      case Output_JSON:
+      case Output_CompactJSON:
+	style = docstyle(out->format);
+	// Trailing commas are not allowed.
+	if (out->count)
+	    fputs(style->listsep, out->fp);
+	fprintf(out->fp, "%s\"class\":\"solution\"", style->itemopen);
+	writesolutionfields(out, style, game, record, solution, moves);
+	break;
+      case Output_NDJSON:
+	// Each line stands on its own, so repeat the file's identity.
+	fprintf(out->fp, "%s\"class\":\"solution\"", compactstyle.itemopen);
+	fprintf(out->fp, "%s\"ruleset\":\"%s\"",
+			 compactstyle.itemsep, ruleset_names[out->ruleset]);
+	if (*out->levelset) {
+	    fprintf(out->fp, "%s\"levelset\":\"", compactstyle.itemsep);
+	    writejsonstr(out->fp, out->levelset);
+	    fputc('"', out->fp);
+	}
+	writesolutionfields(out, &compactstyle, game, record, solution,
+			    moves);
+	fputc('\n', out->fp);
+	break;
+      case Output_Columnar:
+	columnar_add(out->columns, game, solution);
+	++out->count;
+	return 0;
+      case Output_CBOR:
+	writecborsolution(out, game, record, solution, moves);
+	break;
+    }
+    ++out->count;
+    fflush(out->fp);
+    return ferror(out->fp) ? -1 : 0;
+}
+
+/* Finish the document and flush the stream.
+ */
+int output_end(outputinfo *out)
+{
+    switch (out->format) {
+      case Output_JSON:
+      case Output_CompactJSON:
+	fputs(docstyle(out->format)->docclose, out->fp);
+	break;
+      case Output_NDJSON:
+	break;
+      case Output_Columnar:
+	columnar_write(out->columns, out->fp);
+	columnar_free(out->columns);
+	out->columns = NULL;
+	break;
+      case Output_CBOR:
+	cbor_putbreak(out->fp);
+	break;
+    }
+    fflush(out->fp);
+    return ferror(out->fp) ? -1 : 0;
+}
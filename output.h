@@ -0,0 +1,68 @@
+/* output.h: Writing converted solution files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_output_h_
+#define	_output_h_
+
+#include	<stdio.h>
+#include	<stdint.h>
+#include	"solution.h"
+
+/* The available output formats.
+ */
+enum {
+    Output_JSON = 0,	/* a single pretty-printed JSON document */
+    Output_CompactJSON,	/* the same document with no extra whitespace */
+    Output_NDJSON,	/* a header line, then one JSON object per line */
+    Output_Columnar,	/* a binary columnar container (see columnar.c) */
+    Output_CBOR,	/* the JSON document model, encoded as CBOR */
+    Output_Count
+};
+
+/* The state of an output stream.
+ */
+typedef struct outputinfo {
+    FILE	       *fp;		/* where the output goes */
+    int			format;		/* one of the Output_* values */
+    int			count;		/* number of solutions written */
+    int			ruleset;	/* the file's ruleset */
+    char		levelset[256];	/* name of the levelset, or "" */
+    struct columninfo  *columns;	/* rows collected for Output_Columnar */
+} outputinfo;
+
+/* Where a solution's record was found in the TWS file. These are
+ * written as extra fields of the solution object when requested.
+ */
+typedef struct recordinfo {
+    long		offset;		/* byte offset of the record, or -1 */
+    unsigned long	size;		/* the record's solutionsize */
+    uint64_t		hash;		/* hash64() of the record's data */
+} recordinfo;
+
+/* Prepare to write a document in the given format to fp.
+ */
+extern void output_init(outputinfo *out, FILE *fp, int format);
+
+/* Write the document header. levelset can be NULL if the file does
+ * not name its levelset, and currentlevel is omitted if it is zero.
+ */
+extern int output_begin(outputinfo *out, int ruleset, int currentlevel,
+			char const *levelset);
+
+/* Write one solution. If solution is NULL, only the level's number
+ * and password are written. moves is the level's movestring. If
+ * record is not NULL, the record's offset, size and hash are added.
+ * The columnar format has no place for them and ignores record.
+ */
+extern int output_solution(outputinfo *out, gamesetup const *game,
+			   recordinfo const *record,
+			   solutioninfo const *solution, char const *moves);
+
+/* Finish the document and flush the stream.
+ */
+extern int output_end(outputinfo *out);
+
+#endif
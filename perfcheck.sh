@@ -0,0 +1,68 @@
+# perfcheck.sh: Compare benchmark results against a baseline.
+#
+# usage: sh perfcheck.sh baseline.ndjson results.ndjson [tolerance]
+#
+# Both files hold the JSON lines written by twsbench. Speeds are
+# compared as relative_speed, the speed of the stage relative to the
+# reference kernel timed alongside it, so that a machine that runs
+# faster or slower as a whole does not change the result. A stage
+# fails if its relative speed has dropped, or the peak RSS has grown,
+# by more than tolerance percent (25 by default). Stages missing from
+# either file are reported but do not fail the check.
+
+set -eu
+
+if [ $# -lt 2 ] || [ $# -gt 3 ]; then
+    echo "usage: sh perfcheck.sh baseline.ndjson results.ndjson [tolerance]" >&2
+    exit 2
+fi
+
+awk -v tolerance="${3:-25}" '
+function field(line, name,    re) {
+    re = "\"" name "\":(\"[^\"]*\"|[-0-9.]+)"
+    if (!match(line, re))
+        return ""
+    line = substr(line, RSTART + length(name) + 3, RLENGTH - length(name) - 3)
+    gsub(/"/, "", line)
+    return line
+}
+FNR == NR {
+    key = field($0, "file") " " field($0, "stage")
+    basespeed[key] = field($0, "relative_speed")
+    baserss[key] = field($0, "peak_rss_kb")
+    next
+}
+{
+    key = field($0, "file") " " field($0, "stage")
+    if (!(key in basespeed)) {
+        printf "%s: not in the baseline\n", key
+        next
+    }
+    seen[key] = 1
+    speed = field($0, "relative_speed")
+    rss = field($0, "peak_rss_kb")
+    if (basespeed[key] <= 0) {
+        printf "%s: no relative speed in the baseline\n", key
+        next
+    }
+    change = (speed - basespeed[key]) * 100 / basespeed[key]
+    status = "ok"
+    if (change < -tolerance) {
+        status = "SLOWER"
+        failed = 1
+    }
+    printf "%s: %.3f MB/s, relative speed %.4f, baseline %.4f (%+.1f%%) %s\n",
+           key, field($0, "mb_per_s"), speed, basespeed[key], change, status
+    if (baserss[key] > 0 && rss > baserss[key] * (1 + tolerance / 100)) {
+        printf "%s: peak RSS %d KiB, baseline %d KiB LARGER\n",
+               key, rss, baserss[key]
+        failed = 1
+    }
+}
+END {
+    for (key in basespeed)
+        if (!(key in seen))
+            printf "%s: missing from the results\n", key
+    exit failed
+}
+' "$1" "$2"
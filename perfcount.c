@@ -0,0 +1,170 @@
+/* perfcount.c: Reading hardware performance counters around stages.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdint.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<unistd.h>
+#include	<sys/ioctl.h>
+#include	<sys/syscall.h>
+#include	<linux/perf_event.h>
+#include	"err.h"
+#include	"stats.h"
+#include	"perfcount.h"
+
+/* The counters are opened as one group, led by the cycle counter, so
+ * that they are scheduled onto the hardware together and a single
+ * read() returns all of them.
+ */
+enum {
+    Counter_Cycles = 0,
+    Counter_Instructions,
+    Counter_Branches,
+    Counter_BranchMisses,
+    Counter_CacheMisses,
+    Counter_Count
+};
+
+static unsigned long long const counterconfigs[Counter_Count] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_MISSES
+};
+
+/* The layout of a read() from a group opened with PERF_FORMAT_GROUP.
+ */
+typedef struct groupread {
+    uint64_t		nr;
+    uint64_t		values[Counter_Count];
+} groupread;
+
+/* The totals of one stage. start holds the counters at the last call
+ * to perf_begin().
+ */
+typedef struct stagecounts {
+    uint64_t		totals[Counter_Count];
+    uint64_t		start[Counter_Count];
+    unsigned long	calls;
+} stagecounts;
+
+static char const *stagenames[Stage_Count] = {
+    "read", "decode", "encode", "write"
+};
+
+int perfcounting = 0;
+
+static int		fds[Counter_Count];
+static stagecounts	stages[Stage_Count];
+
+static int openevent(unsigned long long config, int group)
+{
+    struct perf_event_attr	attr;
+
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+int perf_open(void)
+{
+    int	i;
+
+    for (i = 0 ; i < Counter_Count ; ++i) {
+	fds[i] = openevent(counterconfigs[i], i ? fds[0] : -1);
+	if (fds[i] < 0) {
+	    warn("perf counters unavailable: %s", strerror(errno));
+	    while (i--)
+		close(fds[i]);
+	    return -1;
+	}
+    }
+    memset(stages, 0, sizeof stages);
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    perfcounting = 1;
+    return 0;
+}
+
+/* Read the current values of the counters. On failure the counters
+ * are closed with a warning, and -1 is returned.
+ */
+static int readcounters(uint64_t *values)
+{
+    groupread	r;
+    ssize_t	n;
+    int		i;
+
+    n = read(fds[0], &r, sizeof r);
+    if (n == sizeof r && r.nr == Counter_Count) {
+	memcpy(values, r.values, sizeof r.values);
+	return 0;
+    }
+    if (n < 0)
+	warn("perf counters unreadable: %s", strerror(errno));
+    else
+	warn("perf counters unreadable: short read");
+    for (i = 0 ; i < Counter_Count ; ++i)
+	close(fds[i]);
+    perfcounting = 0;
+    return -1;
+}
+
+void perf_begin(int stage)
+{
+    if (!perfcounting)
+	return;
+    readcounters(stages[stage].start);
+}
+
+void perf_end(int stage)
+{
+    uint64_t	now[Counter_Count];
+    int		i;
+
+    if (!perfcounting || readcounters(now) < 0)
+	return;
+    for (i = 0 ; i < Counter_Count ; ++i)
+	stages[stage].totals[i] += now[i] - stages[stage].start[i];
+    ++stages[stage].calls;
+}
+
+void perf_close(FILE *fp)
+{
+    uint64_t const     *t;
+    int			i;
+
+    if (!perfcounting)
+	return;
+    for (i = 0 ; i < Stage_Count ; ++i) {
+	if (!stages[i].calls)
+	    continue;
+	t = stages[i].totals;
+	fprintf(fp, "%-6s cycles %llu  instructions %llu  IPC %.2f\n",
+		stagenames[i], (unsigned long long)t[Counter_Cycles],
+		(unsigned long long)t[Counter_Instructions],
+		t[Counter_Cycles] ? (double)t[Counter_Instructions]
+					/ t[Counter_Cycles] : 0.0);
+	fprintf(fp, "%-6s branches %llu  misses %llu (%.2f%%)"
+		    "  cache misses %llu\n",
+		stagenames[i], (unsigned long long)t[Counter_Branches],
+		(unsigned long long)t[Counter_BranchMisses],
+		t[Counter_Branches] ? 100.0 * t[Counter_BranchMisses]
+				    / t[Counter_Branches] : 0.0,
+		(unsigned long long)t[Counter_CacheMisses]);
+    }
+    for (i = 0 ; i < Counter_Count ; ++i)
+	close(fds[i]);
+    perfcounting = 0;
+}
@@ -0,0 +1,37 @@
+/* perfcount.h: Reading hardware performance counters around stages.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_perfcount_h_
+#define	_perfcount_h_
+
+#include	<stdio.h>
+
+/* Nonzero while the counters are open. The other functions do
+ * nothing when it is zero.
+ */
+extern int perfcounting;
+
+/* Open the cycle, instruction, branch, branch miss and cache miss
+ * counters for this thread. The return value is negative if the
+ * kernel does not allow them (see perf_event_paranoid), in which case
+ * a warning has been written.
+ */
+extern int perf_open(void);
+
+/* Read the counters at the start and at the end of a stage, and add
+ * the difference to the stage's totals. stage is one of the Stage_*
+ * values of stats.h. If the counters cannot be read, they are closed
+ * with a warning, as if perf_open() had failed.
+ */
+extern void perf_begin(int stage);
+extern void perf_end(int stage);
+
+/* Write the totals of each stage, with the instructions per cycle
+ * and the branch miss rate, to fp, and close the counters.
+ */
+extern void perf_close(FILE *fp);
+
+#endif
@@ -0,0 +1,94 @@
+/* repack.c: Rewriting TWS files at their smallest size.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<errno.h>
+#include	"err.h"
+#include	"fileio.h"
+#include	"solution.h"
+#include	"repack.h"
+
+/* Copy the records of in to out, repacking each solution.
+ */
+static int repackrecords(fileinfo *in, fileinfo *out)
+{
+    gamesetup		game;
+    unsigned char	extra[256];
+    int			ruleset, currentlevel, extrasize;
+    int			ok = TRUE;
+
+    if (!readsolutionheader(in, &ruleset, &currentlevel, &extrasize, extra))
+	return FALSE;
+    if (!writesolutionheader(out, ruleset, currentlevel, extrasize, extra))
+	return FALSE;
+
+    memset(&game, 0, sizeof game);
+    while (ok && !filetestend(in)) {
+	/* Anything short of a clean end of file is an error here, as
+	 * the rest of the file would otherwise be silently dropped.
+	 */
+	if (!readsolution(in, &game)) {
+	    ok = FALSE;
+	    break;
+	}
+	if (game.sgflags & SGF_SETNAME)
+	    ok = writesolutionsetname(out, game.name);
+	else if (game.solutionsize > 16)
+	    ok = repacksolution(&game) && writesolution(out, &game);
+	else if (game.sgflags & SGF_HASPASSWD)
+	    ok = writesolution(out, &game);
+	clearsolution(&game);
+    }
+    clearsolution(&game);
+    return ok;
+}
+
+/* Re-encode every solution in the named TWS file.
+ */
+int repackfile(char const *filename)
+{
+    fileinfo	in, out;
+    char       *tmpname;
+    long	oldsize, newsize;
+    int		ok;
+
+    clearfileinfo(&in);
+    if (!fileopen(&in, filename, "rb", "file error"))
+	return -1;
+
+    tmpname = NULL;
+    xalloc(tmpname, strlen(filename) + 5);
+    sprintf(tmpname, "%s.new", filename);
+    clearfileinfo(&out);
+    if (!fileopen(&out, tmpname, "wb", "file error")) {
+	fileclose(&in, NULL);
+	free(tmpname);
+	return -1;
+    }
+
+    ok = repackrecords(&in, &out);
+    oldsize = ftell(in.fp);
+    newsize = ftell(out.fp);
+    fileclose(&in, NULL);
+    if (fflush(out.fp))
+	ok = fileerr(&out, "write error");
+    fileclose(&out, "write error");
+
+    if (ok && rename(tmpname, filename)) {
+	errmsg(filename, "cannot replace file: %s", strerror(errno));
+	ok = FALSE;
+    }
+    if (!ok) {
+	remove(tmpname);
+	free(tmpname);
+	return -1;
+    }
+    printf("%s: %ld -> %ld bytes\n", filename, oldsize, newsize);
+    free(tmpname);
+    return 0;
+}
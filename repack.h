@@ -0,0 +1,18 @@
+/* repack.h: Rewriting TWS files at their smallest size.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_repack_h_
+#define	_repack_h_
+
+/* Re-encode every solution in the named TWS file with
+ * repacksolution(), replacing the file. The new file is written
+ * beside the old one and renamed over it, so the original is left
+ * untouched if anything fails. The old and new sizes are reported on
+ * standard output. The return value is negative on failure.
+ */
+extern int repackfile(char const *filename);
+
+#endif
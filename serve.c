@@ -0,0 +1,253 @@
+/* serve.c: A local conversion daemon listening on a Unix domain socket.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<signal.h>
+#include	<unistd.h>
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<sys/socket.h>
+#include	<sys/un.h>
+#include	<sys/wait.h>
+#include	"err.h"
+#include	"fileio.h"
+#include	"serve.h"
+
+/* Set by the signal handler when it is time to shut down.
+ */
+static volatile sig_atomic_t	stopping = 0;
+
+static void onstopsignal(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
+
+/* Install the signal handlers. SA_RESTART is deliberately left out so
+ * that a blocking accept() or wait() notices the signal.
+ */
+static void setsignals(void)
+{
+    struct sigaction	act;
+
+    memset(&act, 0, sizeof act);
+    act.sa_handler = onstopsignal;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    act.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &act, NULL);
+}
+
+/* Create the listening socket, replacing a stale socket left behind
+ * by an earlier daemon.
+ */
+static int openlistener(char const *path)
+{
+    struct sockaddr_un	addr;
+    struct stat		st;
+    int			fd;
+
+    if (strlen(path) >= sizeof addr.sun_path) {
+	errmsg(path, "socket path is too long");
+	return -1;
+    }
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+	errmsg(path, "%s", strerror(errno));
+	return -1;
+    }
+
+    // A socket left behind by a daemon that has exited is replaced,
+    // but not one that a running daemon still answers on.
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+	if (!connect(fd, (struct sockaddr*)&addr, sizeof addr)) {
+	    errmsg(path, "socket is in use by another daemon");
+	    close(fd);
+	    return -1;
+	}
+	unlink(path);
+    }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof addr) < 0
+		|| listen(fd, SOMAXCONN) < 0) {
+	errmsg(path, "%s", strerror(errno));
+	close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+/* Convert file into a memory buffer, and send the result to out only
+ * if the whole conversion succeeds, so that a client never receives
+ * part of a document.
+ */
+static void answer(fileinfo *file, FILE *out, serveconvertfn convert,
+		   void *data)
+{
+    FILE       *doc;
+    char       *buf = NULL;
+    size_t	size = 0;
+    int		r;
+
+    doc = open_memstream(&buf, &size);
+    if (!doc) {
+	errmsg(file->name, "%s", strerror(errno));
+	return;
+    }
+    r = convert(file, doc, data);
+    if (fclose(doc) || r < 0) {
+	free(buf);
+	return;
+    }
+    fwrite(buf, 1, size, out);
+    free(buf);
+}
+
+/* Read one request from the connection and answer it.
+ */
+static void serveclient(int fd, serveconvertfn convert, void *data)
+{
+    fileinfo	request, file;
+    FILE       *out;
+    char       *path;
+    int		len, outfd;
+
+    clearfileinfo(&request);
+    request.name = "<socket>";
+    outfd = dup(fd);
+    if (outfd < 0 || !(request.fp = fdopen(fd, "rb"))) {
+	close(fd);
+	if (outfd >= 0)
+	    close(outfd);
+	return;
+    }
+    if (!(out = fdopen(outfd, "wb"))) {
+	close(outfd);
+	fileclose(&request, NULL);
+	return;
+    }
+
+    path = getpathbuffer();
+    len = getpathbufferlen();
+    // The path need not end in a newline if the client shut down its
+    // end of the connection after it, so strip one only if present.
+    if (!fgets(path, len, request.fp)) {
+	fileerr(&request, "bad request");
+    } else if ((len = strlen(path)) && path[len - 1] != '\n'
+				     && !feof(request.fp)) {
+	fileerr(&request, "bad request: path too long");
+    } else {
+	if (len && path[len - 1] == '\n')
+	    path[--len] = '\0';
+	if (len == 0) {
+	    answer(&request, out, convert, data);
+	} else {
+	    clearfileinfo(&file);
+	    if (fileopen(&file, path, "rb", "file error")) {
+		answer(&file, out, convert, data);
+		fileclose(&file, "error");
+	    }
+	}
+    }
+    free(path);
+
+    fclose(out);
+    fileclose(&request, NULL);
+}
+
+/* The main loop of a worker process.
+ */
+static void worker(int listenfd, serveconvertfn convert, void *data)
+{
+    int	fd;
+
+    while (!stopping) {
+	fd = accept(listenfd, NULL, NULL);
+	if (fd < 0) {
+	    if (errno != EINTR && errno != ECONNABORTED)
+		warn("accept: %s", strerror(errno));
+	    continue;
+	}
+	serveclient(fd, convert, data);
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+/* Fork a new worker process.
+ */
+static pid_t spawnworker(int listenfd, serveconvertfn convert, void *data)
+{
+    pid_t	pid;
+
+    fflush(NULL);
+    pid = fork();
+    if (pid < 0)
+	warn("fork: %s", strerror(errno));
+    else if (pid == 0)
+	worker(listenfd, convert, data);
+    return pid;
+}
+
+/* Start the worker pool and supervise it, replacing any worker that
+ * exits unexpectedly.
+ */
+int servesocket(char const *path, int workers,
+		serveconvertfn convert, void *data)
+{
+    pid_t      *pids = NULL;
+    pid_t	pid;
+    int		listenfd, status, i;
+
+    if (workers <= 0)
+	workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers <= 0)
+	workers = 1;
+
+    listenfd = openlistener(path);
+    if (listenfd < 0)
+	return -1;
+    setsignals();
+
+    xalloc(pids, workers * sizeof *pids);
+    for (i = 0 ; i < workers ; ++i)
+	pids[i] = spawnworker(listenfd, convert, data);
+
+    while (!stopping) {
+	pid = wait(&status);
+	if (pid < 0) {
+	    if (errno == EINTR)
+		continue;
+	    break;
+	}
+	for (i = 0 ; i < workers ; ++i) {
+	    if (pids[i] == pid) {
+		pids[i] = -1;
+		if (!stopping) {
+		    warn("worker %ld exited; restarting", (long)pid);
+		    pids[i] = spawnworker(listenfd, convert, data);
+		}
+		break;
+	    }
+	}
+    }
+
+    for (i = 0 ; i < workers ; ++i)
+	if (pids[i] > 0)
+	    kill(pids[i], SIGTERM);
+    while (wait(&status) > 0 || errno == EINTR) ;
+
+    free(pids);
+    close(listenfd);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,39 @@
+/* serve.h: A local conversion daemon listening on a Unix domain socket.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_serve_h_
+#define	_serve_h_
+
+#include	<stdio.h>
+#include	"fileio.h"
+
+/* The function called to handle one request. file is open for
+ * reading, and the response is written to out. The return value is
+ * negative on failure.
+ */
+typedef int (*serveconvertfn)(fileinfo *file, FILE *out, void *data);
+
+/* Listen on the Unix domain socket at path and answer requests until
+ * a SIGINT or SIGTERM is received. Requests are handled by a pool of
+ * workers processes, which are forked once at startup and then reused
+ * for every connection. If workers is zero, one worker per online CPU
+ * is started.
+ *
+ * A client sends one line, which is either the pathname of a TWS file
+ * to convert, or an empty line followed by the raw bytes of a TWS
+ * file. In the latter case the client must shut down its side of the
+ * connection after sending the data. The converted document is sent
+ * back once the whole file has been converted, and the connection is
+ * then closed. Nothing is sent if the conversion fails; the error is
+ * reported on the daemon's standard error.
+ *
+ * An existing socket at path is replaced, unless a daemon is still
+ * listening on it, in which case -1 is returned.
+ */
+extern int servesocket(char const *path, int workers,
+		       serveconvertfn convert, void *data);
+
+#endif
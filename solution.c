@@ -232,32 +232,28 @@ int readsolutionheader(fileinfo *file, int *ruleset, int *flags,
 
 /* Write the header bytes to the given solution file.
  */
-/*
-static int writesolutionheader(fileinfo *file, int ruleset, int flags,
-			       int extrasize, unsigned char const *extra)
+int writesolutionheader(fileinfo *file, int ruleset, int flags,
+			int extrasize, unsigned char const *extra)
 {
-    return filewriteint32(file, CSSIG, NULL)
-	&& filewriteint8(file, ruleset, NULL)
-	&& filewriteint16(file, flags, NULL)
-	&& filewriteint8(file, extrasize, NULL)
-	&& filewrite(file, extra, extrasize, NULL);
+    return filewriteint32(file, CSSIG, "write error")
+	&& filewriteint8(file, ruleset, "write error")
+	&& filewriteint16(file, flags, "write error")
+	&& filewriteint8(file, extrasize, "write error")
+	&& filewrite(file, extra, extrasize, "write error");
 }
-*/
 
 /* Write the name of the level set to the given solution file.
  */
-/*
-static int writesolutionsetname(fileinfo *file, char const *setname)
+int writesolutionsetname(fileinfo *file, char const *setname)
 {
     char	zeroes[16] = "";
     int		n;
 
     n = strlen(setname) + 1;
-    return filewriteint32(file, n + 16, NULL)
-	&& filewrite(file, zeroes, 16, NULL)
-	&& filewrite(file, setname, n, NULL);
+    return filewriteint32(file, n + 16, "write error")
+	&& filewrite(file, zeroes, 16, "write error")
+	&& filewrite(file, setname, n, "write error");
 }
-*/
 
 /*
  * Solution translation.
@@ -347,34 +343,103 @@ int expandsolution(solutioninfo *solution, gamesetup const *game)
     return FALSE;
 }
 
-/* Take the given solution and compress it, storing the compressed
- * data as part of the level's setup.
+/* Count the values in a level's solution data that use each of the
+ * four formats. Only the first byte of each value is examined.
  */
-int contractsolution(solutioninfo const *solution, gamesetup *game)
+int countsolutionformats(gamesetup const *game, unsigned long counts[4])
 {
-    action const       *move;
-    unsigned char      *data;
-    int			size, delta, when, i;
+    unsigned char const	       *p, *dataend;
 
-    free(game->solutiondata);
-    game->solutionsize = 0;
-    game->solutiondata = NULL;
-    if (!solution->moves.count)
-	return TRUE;
-
-    size = 21;
-    move = solution->moves.list + 1;
-    for (i = 1 ; i < solution->moves.count ; ++i, ++move)
-	size += !isorthogonal(move->dir) ? 5
-			: move[0].when - move[-1].when <= (1 << 3) ? 1
-			: move[0].when - move[-1].when <= (1 << 11) ? 2 : 4;
-    data = malloc(size);
-    if (!data) {
-	errmsg(NULL, "failed to record level %d solution:"
-		     " out of memory", game->number);
+    if (game->solutionsize <= 16)
 	return FALSE;
+    p = game->solutiondata + 16;
+    dataend = game->solutiondata + game->solutionsize;
+    while (p < dataend) {
+	switch (*p & 0x03) {
+	  case 0:
+	    ++counts[2];
+	    ++p;
+	    break;
+	  case 1:
+	    ++counts[0];
+	    ++p;
+	    break;
+	  case 2:
+	    ++counts[0];
+	    p += 2;
+	    break;
+	  case 3:
+	    if (*p & 0x10) {
+		++counts[3];
+		p += 2 + ((*p >> 2) & 0x03);
+	    } else {
+		++counts[1];
+		p += 4;
+	    }
+	    break;
+	}
+    }
+    return p == dataend;
+}
+
+/* Write the smallest single-move encoding of a move to data, which
+ * can be NULL to only measure it. The return value is the number of
+ * bytes needed, or zero if the move cannot be encoded.
+ */
+static int encodemove(unsigned char *data, int dir, unsigned long delta)
+{
+    unsigned char	buf[5];
+    int			size, n;
+
+    if (!data)
+	data = buf;
+    if (isdirectmove(dir) && dir != NIL && delta < (1 << 11)) {
+	data[0] = 0x01 | (dirtoindex(dir) << 2) | ((delta << 5) & 0xE0);
+	if (delta < (1 << 3))
+	    return 1;
+	data[0] ^= 0x03;
+	data[1] = (delta >> 3) & 0xFF;
+	return 2;
+    }
+    size = delta < (1 << 2) ? 2 : delta < (1 << 10) ? 3
+			    : delta < (1 << 18) ? 4 : delta < (1 << 26) ? 5 : 0;
+    if (isorthogonal(dir) && dir != NIL && (!size || size >= 4)
+		&& delta < (1 << 27)) {
+	data[0] = 0x03 | (dirtoindex(dir) << 2) | ((delta << 5) & 0xE0);
+	data[1] = (delta >> 3) & 0xFF;
+	data[2] = (delta >> 11) & 0xFF;
+	data[3] = (delta >> 19) & 0xFF;
+	return 4;
     }
+    if (!size)
+	return 0;
+    data[0] = 0x13 | ((size - 2) << 2) | ((dir << 5) & 0xE0);
+    data[1] = ((dir >> 3) & 0x3F) | ((delta & 0x03) << 6);
+    for (n = 2 ; n < size ; ++n)
+	data[n] = (delta >> (2 + (n - 2) * 8)) & 0xFF;
+    return size;
+}
 
+/* TRUE if the three moves starting at move can be packed into one
+ * byte (format #3). prev is the time of the move before them.
+ */
+#define	ispackable(move, prev)					\
+    ((move)[0].when - (prev) == 4 && isorthogonal((move)[0].dir)	\
+				  && (move)[0].dir != NIL		\
+     && (move)[1].when - (move)[0].when == 4			\
+				  && isorthogonal((move)[1].dir)	\
+				  && (move)[1].dir != NIL		\
+     && (move)[2].when - (move)[1].when == 4			\
+				  && isorthogonal((move)[2].dir)	\
+				  && (move)[2].dir != NIL)
+
+/* Write the 16 bytes that precede the moves in a level's solution
+ * data.
+ */
+static void writesolutionprefix(unsigned char *data,
+				solutioninfo const *solution,
+				gamesetup const *game)
+{
     data[0] = game->number & 0xFF;
     data[1] = (game->number >> 8) & 0xFF;
     data[2] = game->passwd[0];
@@ -391,72 +456,182 @@ int contractsolution(solutioninfo const *solution, gamesetup *game)
     data[13] = (game->besttime >> 8) & 0xFF;
     data[14] = (game->besttime >> 16) & 0xFF;
     data[15] = (game->besttime >> 24) & 0xFF;
+}
 
-    when = -1;
-    size = 16;
+/* Compress the given solution into buf in a single pass. No move
+ * takes more than five bytes, so the buffer is grown once, up front,
+ * to the worst case, and the moves are then written straight into it.
+ * The common one-byte forms are handled before anything else. The
+ * null solution leaves buf empty, as contractsolution() leaves the
+ * level without solution data.
+ */
+int contractsolutionbuf(solutioninfo const *solution, gamesetup const *game,
+			solutionbuf *buf)
+{
+    action const       *move, *end;
+    unsigned char      *p;
+    long		prev, delta;
+    int			need, idx, n;
+
+    if (!solution->moves.count) {
+	buf->size = 0;
+	return TRUE;
+    }
+    need = 16 + 5 * solution->moves.count;
+    if (buf->allocated < need) {
+	buf->allocated = buf->allocated * 2 > need ? buf->allocated * 2 : need;
+	xalloc(buf->data, buf->allocated);
+    }
+    writesolutionprefix(buf->data, solution, game);
+
+    p = buf->data + 16;
+    prev = -1;
     move = solution->moves.list;
-    for (i = 0 ; i < solution->moves.count ; ++i, ++move) {
-	delta = -when - 1;
-	when = move->when;
-	delta += when;
-	if (ismousemove(move->dir)
-			|| (isdiagonal(move->dir) && delta >= (1 << 11))) {
-	    data[size] = 0x13 | ((move->dir << 5) & 0xE0);
-	    data[size + 1] = ((move->dir >> 3) & 0x3F) | ((delta & 0x03) << 6);
-	    if (delta < (1 << 2)) {
-		size += 2;
-	    } else {
-		data[size + 2] = (delta >> 2) & 0xFF;
-		if (delta < (1 << 10)) {
-		    data[size] |= 1 << 2;
-		    size += 3;
-		} else {
-		    data[size + 3] = (delta >> 10) & 0xFF;
-		    if (delta < (1 << 18)) {
-			data[size] |= 2 << 2;
-			size += 4;
-		    } else {
-			data[size + 4] = (delta >> 18) & 0xFF;
-			data[size] |= 3 << 2;
-			size += 5;
-		    }
-		}
-	    }
-	} else if (delta == 3 && i + 2 < solution->moves.count
-			      && isorthogonal(move[0].dir)
-			      && move[1].when - move[0].when == 4
-			      && isorthogonal(move[1].dir)
-			      && move[2].when - move[1].when == 4
-			      && isorthogonal(move[2].dir)) {
-	    data[size++] = (dirtoindex(move[0].dir) << 2)
-			 | (dirtoindex(move[1].dir) << 4)
-			 | (dirtoindex(move[2].dir) << 6);
+    end = move + solution->moves.count;
+    for ( ; move < end ; ++move) {
+	delta = move->when - prev - 1;
+	prev = move->when;
+	idx = move->dir < 16 ? diridx8[move->dir] : -1;
+	if (delta == 3 && end - move >= 3 && ispackable(move, move->when - 4)) {
+	    *p++ = (idx << 2) | (dirtoindex(move[1].dir) << 4)
+			      | (dirtoindex(move[2].dir) << 6);
 	    move += 2;
-	    i += 2;
-	    when = move->when;
-	} else if (delta < (1 << 3)) {
-	    data[size++] = 0x01 | (dirtoindex(move->dir) << 2)
-				| ((delta << 5) & 0xE0);
-	} else if (delta < (1 << 11)) {
-	    data[size++] = 0x02 | (dirtoindex(move->dir) << 2)
-				| ((delta << 5) & 0xE0);
-	    data[size++] = (delta >> 3) & 0xFF;
+	    prev = move->when;
+	} else if (idx >= 0 && delta < (1 << 3)) {
+	    *p++ = 0x01 | (idx << 2) | (delta << 5);
 	} else {
-	    data[size++] = 0x03 | (dirtoindex(move->dir) << 2)
-				| ((delta << 5) & 0xE0);
-	    data[size++] = (delta >> 3) & 0xFF;
-	    data[size++] = (delta >> 11) & 0xFF;
-	    data[size++] = (delta >> 19) & 0xFF;
+	    n = encodemove(p, move->dir, delta);
+	    if (!n) {
+		errmsg(NULL, "failed to record level %d solution:"
+			     " move %d cannot be encoded", game->number,
+		       (int)(move - solution->moves.list));
+		buf->size = 0;
+		return FALSE;
+	    }
+	    p += n;
 	}
     }
+    buf->size = p - buf->data;
+    return TRUE;
+}
 
-    game->solutionsize = size;
-    game->solutiondata = realloc(data, size);
-    if (!game->solutiondata)
-	game->solutiondata = data;
+/* Take the given solution and compress it, storing the compressed
+ * data as part of the level's setup.
+ */
+int contractsolution(solutioninfo const *solution, gamesetup *game)
+{
+    solutionbuf	buf = { 0, 0, NULL };
+
+    free(game->solutiondata);
+    game->solutionsize = 0;
+    game->solutiondata = NULL;
+    if (!solution->moves.count)
+	return TRUE;
+
+    if (!contractsolutionbuf(solution, game, &buf)) {
+	free(buf.data);
+	return FALSE;
+    }
+    game->solutiondata = malloc(buf.size);
+    if (!game->solutiondata) {
+	errmsg(NULL, "failed to record level %d solution:"
+		     " out of memory", game->number);
+	free(buf.data);
+	return FALSE;
+    }
+    memcpy(game->solutiondata, buf.data, buf.size);
+    game->solutionsize = buf.size;
+    free(buf.data);
     return TRUE;
 }
 
+/* Re-encode a level's solution data at the smallest possible size.
+ * The size of the encoding from each move onwards is computed from
+ * the last move backwards, choosing at each step between a single
+ * move and a packed triple (format #3).
+ */
+int repacksolution(gamesetup *game)
+{
+    solutioninfo	orig, copy;
+    action const       *move;
+    unsigned char      *data = NULL;
+    unsigned char      *olddata;
+    unsigned char      *choice = NULL;
+    int		       *cost = NULL;
+    long		prev;
+    int			n, i, size, oldsize, single, ok = FALSE;
+
+    memset(&orig, 0, sizeof orig);
+    memset(&copy, 0, sizeof copy);
+    if (!expandsolution(&orig, game))
+	goto done;
+    n = orig.moves.count;
+    move = orig.moves.list;
+
+    xalloc(cost, (n + 1) * sizeof *cost);
+    xalloc(choice, n + 1);
+    cost[n] = 0;
+    for (i = n - 1 ; i >= 0 ; --i) {
+	prev = i ? (long)move[i - 1].when : -1;
+	single = encodemove(NULL, move[i].dir, move[i].when - prev - 1);
+	if (!single) {
+	    errmsg(NULL, "level %d: move %d cannot be encoded",
+		   game->number, i);
+	    goto done;
+	}
+	cost[i] = single + cost[i + 1];
+	choice[i] = 1;
+	if (i + 3 <= n && ispackable(move + i, prev) && 1 + cost[i + 3] < cost[i]) {
+	    cost[i] = 1 + cost[i + 3];
+	    choice[i] = 3;
+	}
+    }
+
+    size = 16 + cost[0];
+    if (size >= game->solutionsize) {
+	ok = TRUE;
+	goto done;
+    }
+    xalloc(data, size);
+    memcpy(data, game->solutiondata, 16);
+    size = 16;
+    for (i = 0 ; i < n ; i += choice[i]) {
+	prev = i ? (long)move[i - 1].when : -1;
+	if (choice[i] == 3)
+	    data[size++] = (dirtoindex(move[i].dir) << 2)
+			 | (dirtoindex(move[i + 1].dir) << 4)
+			 | (dirtoindex(move[i + 2].dir) << 6);
+	else
+	    size += encodemove(data + size, move[i].dir,
+			       move[i].when - prev - 1);
+    }
+
+    /* Only keep the new data if it decodes to exactly the same moves.
+     */
+    olddata = game->solutiondata;
+    oldsize = game->solutionsize;
+    game->solutiondata = data;
+    game->solutionsize = size;
+    ok = expandsolution(&copy, game) && copy.moves.count == n
+		&& !memcmp(copy.moves.list, move, n * sizeof *move);
+    if (ok) {
+	data = olddata;
+    } else {
+	errmsg(NULL, "level %d: repacked solution does not match",
+	       game->number);
+	game->solutiondata = olddata;
+	game->solutionsize = oldsize;
+    }
+
+  done:
+    free(data);
+    free(cost);
+    free(choice);
+    destroymovelist(&orig.moves);
+    destroymovelist(&copy.moves);
+    return ok;
+}
+
 /*
  * File I/O for level solutions.
  */
@@ -519,8 +694,7 @@ int readsolution(fileinfo *file, gamesetup *game)
 /* Write the data of one complete solution from the appropriate fields
  * of game to the given file.
  */
-/*
-static int writesolution(fileinfo *file, gamesetup const *game)
+int writesolution(fileinfo *file, gamesetup const *game)
 {
     if (game->solutionsize) {
 	if (!filewriteint32(file, game->solutionsize, "write error")
@@ -535,7 +709,7 @@ static int writesolution(fileinfo *file, gamesetup const *game)
     }
 
     return TRUE;
-}*/
+}
 
 /* Free all memory allocated for storing a solution.
  */
@@ -92,6 +92,14 @@ typedef struct actlist {
     action	       *list;		/* the array */
 } actlist;
 
+/* A reusable buffer for holding compressed solution data.
+ */
+typedef struct solutionbuf {
+    int			allocated;	/* number of bytes allocated */
+    int			size;		/* number of bytes in use */
+    unsigned char      *data;		/* the buffer */
+} solutionbuf;
+
 /* A structure holding all the data needed to reconstruct a solution.
  */
 typedef	struct solutioninfo {
@@ -110,7 +118,22 @@ typedef	struct solutioninfo {
 #define	MOUSERANGEMAX	+9
 #define	MOUSERANGE	19
 
-enum { CmdKeyMoveLast = NORTH | WEST | SOUTH | EAST };
+/* Commands stored in a move's dir field. Values above CmdKeyMoveLast
+ * are mouse moves, relative to Chip's position; CmdMoveNop is a click
+ * on Chip himself.
+ */
+enum {
+    CmdKeyMoveLast = NORTH | WEST | SOUTH | EAST,
+    CmdMouseMoveFirst,
+    CmdMoveNop = CmdMouseMoveFirst - MOUSERANGEMIN - MOUSERANGEMIN * MOUSERANGE,
+    CmdMouseMoveLast = CmdMouseMoveFirst + MOUSERANGE * MOUSERANGE - 1
+};
+
+/* Translating between mouse move commands and offsets from Chip.
+ */
+#define	mousemovecmd(x, y)	(CmdMoveNop + (y) * MOUSERANGE + (x))
+#define	mousemovex(cmd)	(((cmd) - CmdMouseMoveFirst) % MOUSERANGE + MOUSERANGEMIN)
+#define	mousemovey(cmd)	(((cmd) - CmdMouseMoveFirst) / MOUSERANGE + MOUSERANGEMIN)
 
 /* True if cmd is a simple directional command, i.e. a single
  * orthogonal or diagonal move (or CmdNone).
@@ -168,11 +191,26 @@ extern void destroymovelist(actlist *list);
 extern int readsolutionheader(fileinfo *file, int *ruleset, int *flags,
 		              int *extrasize, unsigned char *extra);
 
+/* Write the header bytes to the given solution file.
+ */
+extern int writesolutionheader(fileinfo *file, int ruleset, int flags,
+			       int extrasize, unsigned char const *extra);
+
+/* Write the name of the level set to the given solution file. This
+ * should immediately follow the header.
+ */
+extern int writesolutionsetname(fileinfo *file, char const *setname);
+
 /* Read the data of a one complete solution from the given file into
  * a gamesetup structure.
  */
 extern int readsolution(fileinfo *file, gamesetup* game);
 
+/* Write the data of one complete solution from the appropriate fields
+ * of game to the given file.
+ */
+extern int writesolution(fileinfo *file, gamesetup const *game);
+
 /* Free all memory allocated for storing a solution.
  */
 extern void clearsolution(gamesetup *game);
@@ -183,10 +221,33 @@ extern void clearsolution(gamesetup *game);
  */
 extern int expandsolution(solutioninfo *solution, gamesetup const *game);
 
+/* Add the number of values in a level's solution data that are
+ * stored in formats #1 to #4 to counts[0] to counts[3]. FALSE is
+ * returned if the solution is absent or its last value is truncated.
+ */
+extern int countsolutionformats(gamesetup const *game,
+				unsigned long counts[4]);
+
 /* Take the given solution and compress it, storing the compressed
  * data as part of the level's setup. FALSE is returned if an error
  * occurs. (It is not an error to compress the null solution.)
  */
 extern int contractsolution(solutioninfo const *solution, gamesetup *game);
 
+/* Compress the given solution into buf, which is grown as needed and
+ * can be reused from one call to the next. The data is not attached
+ * to game. The null solution leaves buf empty. FALSE is returned if a
+ * move cannot be encoded.
+ */
+extern int contractsolutionbuf(solutioninfo const *solution,
+			       gamesetup const *game, solutionbuf *buf);
+
+/* Re-encode a level's solution data at the smallest possible size,
+ * choosing among the byte formats so as to minimize the total rather
+ * than greedily. The data is only replaced if the new encoding is
+ * smaller and expands to exactly the same moves. FALSE is returned if
+ * the solution data is invalid.
+ */
+extern int repacksolution(gamesetup *game);
+
 #endif
@@ -0,0 +1,99 @@
+/* stats.c: Counting and timing the stages of a conversion.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+#include	<time.h>
+#include	"allocstats.h"
+#include	"isa.h"
+#include	"perfcount.h"
+#include	"trace.h"
+#include	"stats.h"
+
+static char const *stagenames[Stage_Count] = {
+    "read", "decode", "encode", "write"
+};
+
+/* The names of the stages in a trace, which are those of the
+ * functions that do the work.
+ */
+static char const *tracenames[Stage_Count] = {
+    "readsolution", "expandsolution", "compressjsonsolution", "output"
+};
+
+/* Read a clock in seconds. Both clocks are read through the vDSO on
+ * Linux, so a pair of readings costs well under a microsecond.
+ */
+static double readclock(clockid_t id)
+{
+    struct timespec	ts;
+
+    clock_gettime(id, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void stats_init(statsinfo *stats)
+{
+    memset(stats, 0, sizeof *stats);
+}
+
+void stats_begin(statsinfo *stats, int stage)
+{
+    if (!stats)
+	return;
+    stats->stages[stage].wallstart = readclock(CLOCK_MONOTONIC);
+    stats->stages[stage].cpustart = readclock(CLOCK_THREAD_CPUTIME_ID);
+    stats->stages[stage].tracestart = trace_now();
+    stats->stages[stage].allocstart = allocstats.allocs;
+    stats->stages[stage].allocbytestart = allocstats.bytes;
+    alloc_mark();
+    perf_begin(stage);
+}
+
+void stats_end(statsinfo *stats, int stage)
+{
+    stagetime  *st;
+
+    if (!stats)
+	return;
+    perf_end(stage);
+    st = &stats->stages[stage];
+    st->wall += readclock(CLOCK_MONOTONIC) - st->wallstart;
+    st->cpu += readclock(CLOCK_THREAD_CPUTIME_ID) - st->cpustart;
+    st->allocs += allocstats.allocs - st->allocstart;
+    st->allocbytes += allocstats.bytes - st->allocbytestart;
+    if (allocstats.mark > st->peaklive)
+	st->peaklive = allocstats.mark;
+    trace_span(tracenames[stage], st->tracestart, NULL, 0);
+}
+
+void stats_print(statsinfo const *stats, FILE *fp)
+{
+    int	i;
+
+    fprintf(fp, "records read:     %lu\n", stats->records);
+    fprintf(fp, "bytes read:       %lu\n", stats->bytes);
+    fprintf(fp, "moves decoded:    %lu\n", stats->moves);
+    for (i = 0 ; i < 4 ; ++i)
+	fprintf(fp, "format #%d values: %lu\n", i + 1, stats->formats[i]);
+    fprintf(fp, "movestring bytes: %lu\n", stats->movestrbytes);
+    fprintf(fp, "scan kernel:      %s\n", isa_name());
+    for (i = 0 ; i < Stage_Count ; ++i)
+	fprintf(fp, "%-6s wall %.6fs  cpu %.6fs\n", stagenames[i],
+		stats->stages[i].wall, stats->stages[i].cpu);
+    if (!allocstats.counting)
+	return;
+    for (i = 0 ; i < Stage_Count ; ++i)
+	fprintf(fp, "%-6s allocations %lu  bytes %lu  peak live %ld\n",
+		stagenames[i], stats->stages[i].allocs,
+		stats->stages[i].allocbytes, stats->stages[i].peaklive);
+    fprintf(fp, "allocations:      %lu\n", allocstats.allocs);
+    fprintf(fp, "bytes allocated:  %lu\n", allocstats.bytes);
+    fprintf(fp, "peak live bytes:  %ld\n", allocstats.peak);
+    fprintf(fp, "steady-state allocations per record: %.2f\n",
+	    stats->records > 1 ? (double)stats->recordallocs
+					/ (stats->records - 1) : 0.0);
+}
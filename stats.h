@@ -0,0 +1,71 @@
+/* stats.h: Counting and timing the stages of a conversion.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_stats_h_
+#define	_stats_h_
+
+#include	<stdio.h>
+
+/* The stages of a conversion.
+ */
+enum {
+    Stage_Read = 0,	/* reading records with readsolution() */
+    Stage_Decode,	/* expanding them with expandsolution() */
+    Stage_Encode,	/* building movestrings */
+    Stage_Write,	/* writing the output */
+    Stage_Count
+};
+
+/* The time spent and the memory allocated in one stage. The start
+ * fields hold the clocks and counters at the last call to
+ * stats_begin().
+ */
+typedef struct stagetime {
+    double		wall;		/* elapsed time, in seconds */
+    double		cpu;		/* CPU time of this thread */
+    unsigned long	allocs;		/* allocations made */
+    unsigned long	allocbytes;	/* bytes allocated */
+    long		peaklive;	/* most bytes live at once */
+    double		wallstart;
+    double		cpustart;
+    double		tracestart;	/* trace_now() at stats_begin() */
+    unsigned long	allocstart;
+    unsigned long	allocbytestart;
+} stagetime;
+
+/* The counters kept for a conversion.
+ */
+typedef struct statsinfo {
+    unsigned long	records;	/* records read */
+    unsigned long	bytes;		/* bytes of TWS data read */
+    unsigned long	moves;		/* moves decoded */
+    unsigned long	formats[4];	/* values in formats #1 to #4 */
+    unsigned long	movestrbytes;	/* movestring bytes produced */
+    unsigned long	recordallocs;	/* allocations made while converting
+					   the records after the first */
+    stagetime		stages[Stage_Count];
+} statsinfo;
+
+/* Reset all counters and times to zero.
+ */
+extern void stats_init(statsinfo *stats);
+
+/* Start and stop the clocks of a stage. The time in between is added
+ * to the stage's totals, as are the allocations made, and it is
+ * recorded as a span if a trace is being recorded. The hardware
+ * counters of perfcount.h are read as well if they are open. Both
+ * functions do nothing if stats is NULL.
+ */
+extern void stats_begin(statsinfo *stats, int stage);
+extern void stats_end(statsinfo *stats, int stage);
+
+/* Write a summary of the counters, times and allocations to fp,
+ * along with the instruction set of the kernels in use. The
+ * allocations are left out unless they are being counted.
+ */
+extern void stats_print(statsinfo const *stats, FILE *fp);
+
+#endif
@@ -7,9 +7,255 @@ for file in tests/*.tws; do
     if ! diff -u "$json.golden" "$json.output"; then
         pass=0
     fi
+
+    # The compact document must match the golden file once the
+    # insignificant whitespace is removed from both.
+    ./tws2json --compact "$file" | tr -d ' \n' >"$json.compact.output"
+    if ! tr -d ' \n' <"$json.golden" | diff -u - "$json.compact.output"; then
+        pass=0
+    fi
+
+    ndjson=${file%.tws}.ndjson
+    ./tws2json --ndjson "$file" >"$ndjson.output"
+    if ! diff -u "$ndjson.golden" "$ndjson.output"; then
+        pass=0
+    fi
+
+    columns=${file%.tws}.twsc
+    ./tws2json --columnar "$file" >"$columns.output"
+    if ! cmp "$columns.golden" "$columns.output"; then
+        pass=0
+    fi
+
+    cbor=${file%.tws}.cbor
+    ./tws2json --cbor "$file" >"$cbor.output"
+    if ! cmp "$cbor.golden" "$cbor.output"; then
+        pass=0
+    fi
+
+    # Converting back must reproduce the original file exactly.
+    ./json2tws "$json.golden" "$file.output"
+    if ! cmp "$file" "$file.output"; then
+        pass=0
+    fi
+    ./json2tws "$ndjson.golden" "$file.output"
+    if ! cmp "$file" "$file.output"; then
+        pass=0
+    fi
 done
 
-if [[ "$pass" = 1 ]]; then
+# Movestrings written by hand, with spaces, runs and repeat counts,
+# must parse to the same moves as their canonical form.
+./json2tws tests/movestring.json tests/movestring.tws.output
+./tws2json tests/movestring.tws.output >tests/movestring.json.output
+if ! diff -u tests/movestring.json.golden tests/movestring.json.output; then
+    pass=0
+fi
+
+# A solution with no moves, or with only waits, has nothing to pack
+# and must be written as a record holding just the password.
+./json2tws tests/nomoves.json tests/nomoves.tws.output
+./tws2json tests/nomoves.tws.output >tests/nomoves.json.output
+if ! diff -u tests/nomoves.json.golden tests/nomoves.json.output; then
+    pass=0
+fi
+
+# Fields that cannot be stored in a TWS record must be rejected, as
+# must a solution without a random seed.
+for bad in '"rndseed":1,"rndslidedir":100000000' \
+        '"rndseed":1,"rndslidedir":18446744073709551617' \
+        '"rndseed":1,"stepping":9999' '"rndseed":4294967296' \
+        '"rndseed":"1"' '"stepping":0'; do
+    printf '{"class":"tws","ruleset":"ms","solutions":[{"class":"solution",%s}]}\n' \
+        "\"number\":1,\"password\":\"ABCD\",\"moves\":\"u\",$bad" \
+        >tests/bad.json.output
+    if ./json2tws tests/bad.json.output tests/bad.tws.output 2>/dev/null; then
+        echo "json2tws accepted $bad"
+        pass=0
+    fi
+done
+
+# Repacking must shrink a file written with oversized encodings to
+# its optimal size without changing any of its moves.
+cp tests/repack/unpacked.tws tests/repack/unpacked.tws.output
+./tws2json --repack tests/repack/unpacked.tws.output >/dev/null
+if ! cmp tests/repack/unpacked.tws.golden tests/repack/unpacked.tws.output; then
+    pass=0
+fi
+./tws2json tests/repack/unpacked.tws >tests/repack/unpacked.json.output
+if ! ./tws2json tests/repack/unpacked.tws.output \
+        | diff -u tests/repack/unpacked.json.output -; then
+    pass=0
+fi
+
+# The record fields locate and identify each record in the file.
+./tws2json --record-info tests/intro-ms_tworld1.3.2.tws \
+    >tests/intro-ms_tworld1.3.2.records.output
+if ! diff -u tests/intro-ms_tworld1.3.2.records.golden \
+        tests/intro-ms_tworld1.3.2.records.output; then
+    pass=0
+fi
+
+# Merging keeps the fastest solution of each level across all files.
+./tws2json --merge tests/merge/ms.tws.output tests/intro-ms.dac.tws \
+    tests/intro-ms_tworld1.1.3.tws tests/intro-ms_tworld1.3.2.tws
+./tws2json tests/merge/ms.tws.output >tests/merge/ms.json.output
+if ! diff -u tests/merge/ms.json.golden tests/merge/ms.json.output; then
+    pass=0
+fi
+
+# Diffing reports the levels whose solutions differ, and exits with 1.
+status=0
+./tws2json --diff tests/intro-ms.dac.tws tests/intro-ms_tworld1.3.2.tws \
+    >tests/diff/ms.output || status=$?
+if [ "$status" != 1 ] || ! diff -u tests/diff/ms.golden tests/diff/ms.output; then
+    pass=0
+fi
+
+# Identical routes are found across files, whatever their level.
+./tws2json --dedup tests/dedup/table.output --jobs 2 \
+    tests/intro-lynx.dac.tws tests/intro-ms.dac.tws >tests/dedup/groups.output
+if ! diff -u tests/dedup/groups.golden tests/dedup/groups.output \
+        || ! diff -u tests/dedup/table.golden tests/dedup/table.output; then
+    pass=0
+fi
+
+# Links in a directory are followed to files but not to directories,
+# so a link back up the tree does not make the search endless.
+tree=tests/dedup/tree.output
+rm -rf "$tree"
+mkdir -p "$tree/sub"
+cp tests/intro-lynx.dac.tws "$tree/a.tws"
+ln -s ../../../intro-ms.dac.tws "$tree/sub/b.tws"
+ln -s .. "$tree/sub/up"
+if ! timeout 10 ./tws2json --dedup tests/dedup/tree.table.output "$tree" \
+        | tail -n 1 | grep -qx '18 solutions, 17 distinct, 1 duplicate groups'; then
+    echo "$tree: wrong dedup of a tree with links"
+    pass=0
+fi
+
+# The generator is reproducible, and its output converts losslessly.
+for ruleset in ms lynx; do
+    gen=tests/twsgen/$ruleset.tws
+    ./twsgen -r $ruleset -n 20 -m 300 -s 1 "$gen.output"
+    if ! cmp "$gen.golden" "$gen.output"; then
+        pass=0
+    fi
+    ./tws2json "$gen.output" >"$gen.json.output"
+    ./json2tws "$gen.json.output" "$gen.json.tws.output"
+    if ! cmp "$gen.output" "$gen.json.tws.output"; then
+        pass=0
+    fi
+done
+
+# The number of allocations made for each record, as counted by the
+# instrumented build, must not grow with the length of the solutions.
+# Each record costs one allocation for its data; the movestring and
+# move list buffers are reused and only grow a few times in a whole
+# file, which stays below one more per record on average.
+./twsgen -r ms -n 100 -m 200000 -s 1 tests/twsgen/long-ms.tws.output
+./twsgen -r lynx -n 100 -m 200000 -s 1 tests/twsgen/long-lynx.tws.output
+for file in tests/twsgen/ms.tws.golden tests/twsgen/lynx.tws.golden \
+        tests/twsgen/long-ms.tws.output tests/twsgen/long-lynx.tws.output; do
+    if ! ./tws2json-allocstats --stats "$file" 2>&1 >/dev/null | awk '
+            /^steady-state allocations per record:/ { found = 1; n = $NF }
+            END { exit !(found && n < 2) }'; then
+        echo "$file: too many allocations per record"
+        pass=0
+    fi
+done
+
+# Every kernel the CPU supports must give the same results. The level
+# set name has characters to escape, on both sides of a block boundary.
+for isa in generic sse2 sse4.2 avx2 avx512; do
+    if ./json2tws --force-isa=$isa 2>&1 | grep -q "not supported"; then
+        continue
+    fi
+    ./json2tws --force-isa=$isa tests/isa/escape.json tests/isa/escape.tws.output
+    ./tws2json --force-isa=$isa tests/isa/escape.tws.output \
+        >tests/isa/escape.json.output
+    if ! diff -u tests/isa/escape.json tests/isa/escape.json.output; then
+        pass=0
+    fi
+    for json in tests/*.json.golden tests/twsgen/*.tws.json.output; do
+        ./json2tws --force-isa=$isa "$json" tests/isa/roundtrip.tws.output
+        ./tws2json tests/isa/roundtrip.tws.output >tests/isa/roundtrip.json.output
+        if ! diff -q "$json" tests/isa/roundtrip.json.output >/dev/null; then
+            echo "$json: differs with --force-isa=$isa"
+            pass=0
+        fi
+    done
+done
+
+# The encoder specialized for each ruleset must still handle the moves
+# that ruleset never makes. Swap the rulesets of the generated files,
+# so that MS sees diagonals and Lynx sees mouse moves.
+for swap in ms:1 lynx:2; do
+    gen=tests/twsgen/${swap%:*}.tws
+    { head -c 4 "$gen.golden"; printf "\\00${swap#*:}"; tail -c +6 "$gen.golden"; } \
+        >"$gen.swapped.output"
+    ./tws2json "$gen.swapped.output" | grep -v '"ruleset"' >"$gen.swapped.json.output"
+    if ! ./tws2json "$gen.golden" | grep -v '"ruleset"' \
+            | diff -u - "$gen.swapped.json.output"; then
+        pass=0
+    fi
+done
+
+# The daemon answers a path with or without its newline, and a file
+# sent as raw bytes after an empty line. It sends nothing for a file
+# it cannot convert to the end, and a second daemon must not take over
+# the socket of a running one.
+sock=tests/serve.sock.output
+rm -f "$sock"
+./tws2json --serve "$sock" --workers 1 2>tests/serve.log.output &
+server=$!
+while [ ! -S "$sock" ]; do sleep 0.1; done
+request() {
+    perl -MIO::Socket::UNIX -e '
+        my $s = IO::Socket::UNIX->new(Peer => $ARGV[0]) or die "$ARGV[0]: $!\n";
+        binmode STDIN; binmode STDOUT; local $/;
+        print $s scalar <STDIN>; $s->shutdown(1); print <$s>;
+    ' "$sock"
+}
+file=tests/intro-ms.dac
+printf '%s\n' "$file.tws" | request >tests/serve.path.output
+printf '%s' "$file.tws" | request >tests/serve.nonewline.output
+{ echo; cat "$file.tws"; } | request >tests/serve.raw.output
+{ echo; head -c 100 "$file.tws"; } | request >tests/serve.damaged.output 2>/dev/null
+status=0
+timeout 5 ./tws2json --serve "$sock" --workers 1 2>/dev/null || status=$?
+if [ $status -ne 1 ]; then
+    echo "second daemon took over $sock"
+    pass=0
+fi
+kill "$server"
+wait "$server" || true
+for form in path nonewline raw; do
+    if ! diff -u "$file.json.golden" tests/serve.$form.output; then
+        pass=0
+    fi
+done
+if [ -s tests/serve.damaged.output ]; then
+    echo "daemon sent part of a damaged file"
+    pass=0
+fi
+
+# Every test solution must survive the round trip through a movestring.
+if ! ./tws2json --verify --jobs 2 tests/*.tws tests/twsgen/*.tws.golden \
+        >tests/verify.output; then
+    cat tests/verify.output
+    pass=0
+fi
+
+# A damaged file must fail verification, not pass on the records
+# before the damage.
+head -c 300 tests/intro-ms.dac.tws >tests/truncated.tws.output
+if ./tws2json --verify tests/truncated.tws.output >/dev/null 2>&1; then
+    echo "--verify passed a truncated file"
+    pass=0
+fi
+
+if [ "$pass" = 1 ]; then
     echo PASS
 else
     exit 1
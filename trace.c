@@ -0,0 +1,177 @@
+/* trace.c: Recording timelines in the Chrome trace event format.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<time.h>
+#include	<unistd.h>
+#include	"err.h"
+#include	"trace.h"
+
+/* Every process appends its spans to the trace file as a JSON array
+ * of complete ("X") events, one per line. Each process keeps its own
+ * buffer, so recording a span costs two clock reads and a store, plus
+ * a copy of the file name for the spans that have one. The buffer is
+ * formatted and written out when it fills up, in a single write() to
+ * a file opened with O_APPEND, so the writes of concurrent workers
+ * never interleave. Workers appear as separate threads of the one
+ * process that started the trace.
+ */
+
+/* The number of spans buffered before they are written out.
+ */
+#define	TRACEBUFSIZE	4096
+
+typedef struct tracespan {
+    char const	       *name;
+    char	       *detail;		/* a copy of the span's detail */
+    double		start;		/* microseconds since trace_open() */
+    double		dur;
+    int			level;
+} tracespan;
+
+int tracing = 0;
+
+static int		tracefd = -1;
+static pid_t		tracepid;	/* the process that opened the trace */
+static double		tracebase;	/* the clock at trace_open() */
+static tracespan	spans[TRACEBUFSIZE];
+static int		spancount;
+
+static double monotonic(void)
+{
+    struct timespec	ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+/* Copy str into buf as the contents of a JSON string, and return the
+ * number of characters written. At most size - 1 are written.
+ */
+static int putjsonstr(char *buf, int size, char const *str)
+{
+    int	n = 0;
+
+    for ( ; *str && n < size - 2 ; ++str) {
+	if ((unsigned char)*str < 0x20)
+	    continue;
+	if (*str == '"' || *str == '\\')
+	    buf[n++] = '\\';
+	buf[n++] = *str;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/* Format and write out the buffered spans.
+ */
+void trace_flush(void)
+{
+    char       *text = NULL;
+    char	detail[512];
+    int		allocated, n, i;
+    pid_t	tid;
+
+    if (!tracing || !spancount)
+	return;
+    allocated = spancount * 256 + 1024;
+    xalloc(text, allocated);
+    tid = getpid();
+    n = 0;
+    for (i = 0 ; i < spancount ; ++i) {
+	if (allocated - n < 1024) {
+	    allocated *= 2;
+	    xalloc(text, allocated);
+	}
+	n += sprintf(text + n, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+			       "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+		     spans[i].name, (int)tracepid, (int)tid,
+		     spans[i].start, spans[i].dur);
+	if (spans[i].detail) {
+	    putjsonstr(detail, sizeof detail, spans[i].detail);
+	    n += sprintf(text + n, "\"file\":\"%s\"%s", detail,
+			 spans[i].level ? "," : "");
+	}
+	if (spans[i].level)
+	    n += sprintf(text + n, "\"level\":%d", spans[i].level);
+	n += sprintf(text + n, "}},\n");
+	free(spans[i].detail);
+    }
+    if (write(tracefd, text, n) != n)
+	warn("trace: %s", strerror(errno));
+    free(text);
+    spancount = 0;
+}
+
+int trace_open(char const *path)
+{
+    tracefd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666);
+    if (tracefd < 0) {
+	errmsg(path, "%s", strerror(errno));
+	return -1;
+    }
+    if (write(tracefd, "[\n", 2) != 2) {
+	errmsg(path, "%s", strerror(errno));
+	close(tracefd);
+	tracefd = -1;
+	return -1;
+    }
+    tracepid = getpid();
+    tracebase = monotonic();
+    spancount = 0;
+    tracing = 1;
+    return 0;
+}
+
+double trace_now(void)
+{
+    return tracing ? monotonic() - tracebase : 0;
+}
+
+void trace_span(char const *name, double start, char const *detail,
+		int level)
+{
+    tracespan  *span;
+
+    if (!tracing)
+	return;
+    if (spancount == TRACEBUFSIZE)
+	trace_flush();
+    span = &spans[spancount++];
+    span->name = name;
+    span->detail = NULL;
+    if (detail) {
+	xalloc(span->detail, strlen(detail) + 1);
+	strcpy(span->detail, detail);
+    }
+    span->start = start;
+    span->dur = monotonic() - tracebase - start;
+    span->level = level;
+}
+
+/* The last event closes the array, since JSON does not allow a comma
+ * after the final element. It names the process for the viewer.
+ */
+void trace_close(void)
+{
+    char	buf[256];
+    int		n;
+
+    if (!tracing || getpid() != tracepid)
+	return;
+    trace_flush();
+    n = sprintf(buf, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+		     "\"args\":{\"name\":\"tws2json\"}}\n]\n", (int)tracepid);
+    if (write(tracefd, buf, n) != n)
+	warn("trace: %s", strerror(errno));
+    close(tracefd);
+    tracefd = -1;
+    tracing = 0;
+}
@@ -0,0 +1,44 @@
+/* trace.h: Recording timelines in the Chrome trace event format.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_trace_h_
+#define	_trace_h_
+
+/* Nonzero while a trace is being recorded. The recording functions
+ * return at once when it is zero, so callers need not check it.
+ */
+extern int tracing;
+
+/* Start recording a trace to the named file. The return value is
+ * negative if the file could not be created.
+ */
+extern int trace_open(char const *path);
+
+/* Return the current time in microseconds since the trace started,
+ * or zero if no trace is being recorded.
+ */
+extern double trace_now(void);
+
+/* Record a span which started at the given time and ends now. name
+ * must be a string constant. detail, if not NULL, is added to the
+ * span's arguments as "file", and level, if not zero, as "level".
+ */
+extern void trace_span(char const *name, double start,
+		       char const *detail, int level);
+
+/* Write out the spans recorded by this process so far. This must be
+ * done before forking, so that the child does not inherit them, and
+ * by each child before it exits.
+ */
+extern void trace_flush(void);
+
+/* Write out any remaining spans and complete the trace file. This
+ * does nothing in any process but the one that called trace_open(),
+ * so it can be registered with atexit() before forking.
+ */
+extern void trace_close(void);
+
+#endif
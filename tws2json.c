@@ -5,502 +5,440 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
+#include <getopt.h>
 
 #include "bstrlib.h"
 
 #include "solution.h"
+#include "jsoncompress.h"
 #include "fileio.h"
 #include "err.h"
-
-#include "version.h"
-
-const char *ruleset_names[] = {
-    "",
-    "lynx", /* Ruleset_Lynx */
-    "ms", /* Ruleset_MS */
-};
-
-typedef struct jsoncompressinfo {
-    bstring	str;
-
-    action	lastmove;
-
-    int	lastmovedir;
-    int	lastmoveduration;
-
-    int	rlemovedir;
-    int	rlemoveduration;
-    int	rlecount;
-} jsoncompressinfo;
-
-int jsoncompress_init(jsoncompressinfo *self);
-void jsoncompress_free(jsoncompressinfo *self);
-int jsoncompress_flush(jsoncompressinfo *self);
-int jsoncompress_finish(jsoncompressinfo *self, unsigned long solutiontime);
-int jsoncompress_addmove(jsoncompressinfo *self, action move, int i);
-int jsoncompress_rle_add(jsoncompressinfo *self, int dir, int duration);
-int jsoncompress_rle_flush(jsoncompressinfo *self);
-
-/**
- * Print the given direction to the movestring buffer.
- *
- * @param duration 1 or 4
- * @returns 0 on success. -1 on failure.
+#include "allocstats.h"
+#include "hash.h"
+#include "isa.h"
+#include "dedup.h"
+#include "diff.h"
+#include "merge.h"
+#include "output.h"
+#include "perfcount.h"
+#include "repack.h"
+#include "serve.h"
+#include "stats.h"
+#include "trace.h"
+#include "verify.h"
+
+/* Buffers which are reused from one conversion to the next.
  */
-int printdir(jsoncompressinfo *self, int dir, int duration)
-{
-    int r = BSTR_OK;
-
-    if (duration == 1) {
-	switch (dir) {
-	case NORTH: r = bconchar(self->str, 'u'); break;
-	case WEST:  r = bconchar(self->str, 'l'); break;
-	case SOUTH: r = bconchar(self->str, 'd'); break;
-	case EAST:  r = bconchar(self->str, 'r'); break;
-	case NORTH|WEST: r = bcatcstr(self->str, "u+l"); break;
-	case NORTH|EAST: r = bcatcstr(self->str, "u+r"); break;
-	case SOUTH|WEST: r = bcatcstr(self->str, "d+l"); break;
-	case SOUTH|EAST: r = bcatcstr(self->str, "d+r"); break;
-	default: goto unknown;
-	}
-    } else if (duration == 4) {
-	switch (dir) {
-	case NORTH: r = bconchar(self->str, 'U'); break;
-	case WEST:  r = bconchar(self->str, 'L'); break;
-	case SOUTH: r = bconchar(self->str, 'D'); break;
-	case EAST:  r = bconchar(self->str, 'R'); break;
-	case NORTH|WEST: r = bcatcstr(self->str, "U+L"); break;
-	case NORTH|EAST: r = bcatcstr(self->str, "U+R"); break;
-	case SOUTH|WEST: r = bcatcstr(self->str, "D+L"); break;
-	case SOUTH|EAST: r = bcatcstr(self->str, "D+R"); break;
-	default: goto unknown;
-	}
-    }
-    if (r != BSTR_OK) {
-	return -1;
-    }
-
-    return 0;
-
-unknown:
-    errmsg("error", "Unknown direction (%d)", dir);
-    return -1;
-}
-
-int printnum(jsoncompressinfo *self, int num)
-{
-    if (BSTR_OK != bformata(self->str, "%d", num)) {
-	return -1;
-    }
-    return 0;
-}
-
-int printwait(jsoncompressinfo *self, int count)
-{
-    int r;
-
-    if (count == 0) {
-    } else if (count == 1) {
-	if (BSTR_OK != bconchar(self->str, ',')) {
-	    return -1;
-	}
-    } else if (count == 2) {
-	if (BSTR_OK != bcatcstr(self->str, ",,")) {
-	    return -1;
-	}
-    } else if (count == 4) {
-	if (BSTR_OK != bconchar(self->str, '.')) {
-	    return -1;
-	}
-    } else {
-	r = printnum(self, count);
-	if (r < 0) {
-	    return r;
-	}
-	if (BSTR_OK != bconchar(self->str, ',')) {
-	    return -1;
-	}
-    }
-    return 0;
-}
-
-/**
- * Initialize a jsoncompressinfo struct.
- */
-int jsoncompress_init(jsoncompressinfo *self)
-{
-    if (self == NULL) {
-	return -1;
-    }
-    self->lastmove.dir = NIL;
-
-    self->lastmovedir = NIL;
-    self->lastmoveduration = 0; // 1 or 4.
-
-    self->rlemovedir = NIL;
-    self->rlemoveduration = 0;
-    self->rlecount = 0;
-
-    self->str = bfromcstr("");
-    if (self->str == NULL) {
-	return -1;
-    }
-
-    return 0;
-}
-
-void jsoncompress_free(jsoncompressinfo *self)
-{
-    if (self == NULL) {
-	return;
-    }
-    bdestroy(self->str);
-}
-
-// Flush means: get rid of any buffered state; flush all moves to the char buffer; we've got something new coming in the pipeline.
-int jsoncompress_flush(jsoncompressinfo *self)
-{
-    int r = 0;
-
-    r = jsoncompress_rle_flush(self);
-    if (r < 0) {
-	goto cleanup;
-    }
-
-    if (self->lastmovedir != NIL) {
-	r = printdir(self, self->lastmovedir, self->lastmoveduration);
-	if (r < 0) {
-	    goto cleanup;
-	}
-    }
-
-cleanup:
-    self->lastmovedir = NIL;
-    self->lastmoveduration = 0;
-
-    if (r < 0) {
-	return r;
-    }
-
-    return 0;
-}
+typedef struct convertinfo {
+    bstring		movestr;	/* the movestring of the current level */
+    solutioninfo	solution;	/* the expanded current solution */
+    int			format;		/* the output format */
+    int			withrecords;	/* add each record's offset and hash */
+    statsinfo	       *stats;		/* counters to update, or NULL */
+} convertinfo;
 
 /**
- *
- * If dir and duration differ from the stored dir and duration, the stored move is flushed.
- *
- * Does nothing if dir is NIL.
+ * Initialize a convertinfo struct.
  */
-int jsoncompress_rle_add(jsoncompressinfo *self, int dir, int duration)
+int convert_init(convertinfo *self)
 {
-    int r = 0;
-
-    if (self == NULL) {
+    memset(self, 0, sizeof *self);
+    self->movestr = bfromcstr("");
+    if (self->movestr == NULL) {
 	return -1;
     }
-
-    if (dir == NIL) {
-	return 0;
-    }
-
-    // If the move is the same as the stored move, just update the count.
-    if (self->rlemovedir != NIL) {
-	if (self->rlemovedir == dir && self->rlemoveduration == duration) {
-	    self->rlecount++;
-	    return 0;
-	}
-    }
-
-    // Otherwise, flush the old move and store the new move.
-    r = jsoncompress_rle_flush(self);
-    self->rlemovedir = dir;
-    self->rlemoveduration = duration;
-    self->rlecount = 1;
-    if (r < 0) {
-	return r;
-    }
-
     return 0;
 }
 
-/**
- * Write the stored move to the buffer.
- *
- * Does nothing if no move is stored
- */
-int jsoncompress_rle_flush(jsoncompressinfo *self)
+void convert_free(convertinfo *self)
 {
-    int r = 0;
-
-    if (self == NULL) {
-	return -1;
-    }
-
-    if (self->rlemovedir != NIL) {
-	if (1 < self->rlecount) {
-	    r = printnum(self, self->rlecount);
-	}
-	if (0 <= r) {
-	    r = printdir(self, self->rlemovedir, self->rlemoveduration);
-	}
-	self->rlemovedir = NIL;
-	self->rlecount = 0;
-    }
-
-    if (r < 0) {
-	return r;
-    }
-
-    return 0;
+    destroymovelist(&self->solution.moves);
+    bdestroy(self->movestr);
+    self->movestr = NULL;
 }
 
 /**
- * Add a move to the stream.
+ * Convert an open TWS file to JSON, writing the result to out.
  *
- * @returns -1 on failure.
- */
-
-// The algorithm is pretty simple:
-// 1. Expand the incoming stream of actions into a stream of moves.
-// 2. Upconvert to 4-moves whenever possible.
-// 3. RL-encode.
-int jsoncompress_addmove(jsoncompressinfo *self, action move, int i)
-{
-    int r;
-    long delta = 1;
-
-    if (self == NULL) {
-	return -1;
-    }
-
-    if (0 < i) {
-	// the ticks between the previous move and the current move.
-	delta = move.when - self->lastmove.when;
-    }
-
-    if (delta <= 0) {
-	errmsg("error", "move %d: bad delta (%d)", i, delta);
-	return -1;
-    }
-
-    // Attempt to upconvert previous move
-    if (self->lastmovedir != NIL && self->lastmoveduration == 1 && 4 <= delta) {
-	self->lastmoveduration = 4;
-	delta -= 3;
-    }
-
-    // We are now finished monkeying with the previous move, so send it along.
-    r = jsoncompress_rle_add(self, self->lastmovedir, self->lastmoveduration);
-    self->lastmovedir = NIL;
-    if (r < 0) {
-	goto end;
-    }
-
-    // If we have any delta time left, flush the previous move and write it out.
-    if (1 < delta) {
-	r = jsoncompress_flush(self);
-	if (r < 0) {
-	    goto end;
-	}
-	r = printwait(self, delta - 1);
-	if (r < 0) {
-	    goto end;
-	}
-    }
-
-end:
-    self->lastmove = move;
-    self->lastmovedir = move.dir;
-    self->lastmoveduration = 1;
-
-    if (r < 0) {
-	return r;
-    }
-
-    return 0;
-}
-
-/**
- * Finish the move stream.
- *
- * You must supply the total solution time, so appropriate waiting can be added.
- */
-int jsoncompress_finish(jsoncompressinfo *self, unsigned long solutiontime)
-{
-    int r;
-
-    if (self == NULL) {
-	return -1;
-    }
-
-    //XXX Attempt to upconvert
-
-    r = jsoncompress_flush(self);
-    if (r < 0) {
-	return r;
-    }
-
-    if (self->lastmove.when < solutiontime) {
-	r = printwait(self, solutiontime - self->lastmove.when - 1);
-	if (r < 0) {
-	    return r;
-	}
-    }
-    return 0;
-}
-
-/**
- * Convert a list of moves to a textual representation.
- *
- * @returns 0 on success. 1 on failure.
+ * @returns 0 on success. -1 on failure.
  */
-int compressjsonsolution(actlist *moves, unsigned long solutiontime, bstring movestr)
+int convertfile(convertinfo *self, fileinfo *file, FILE *out)
 {
-    jsoncompressinfo jsoncompress;
-    int i, r;
-
-    r = jsoncompress_init(&jsoncompress);
-    if (r < 0) {
-	return r;
-    }
-
-    for (i = 0; i < moves->count; i++) {
-	r = jsoncompress_addmove(&jsoncompress, moves->list[i], i);
-	if (r < 0) {
-	    goto cleanup;
-	}
-    }
-    r = jsoncompress_finish(&jsoncompress, solutiontime);
-    if (r < 0) {
-	goto cleanup;
-    }
-
-    bassign(movestr, jsoncompress.str);
-    jsoncompress_free(&jsoncompress);
-
-    return 0;
-
-cleanup:
-    jsoncompress_free(&jsoncompress);
-    return r;
-}
-
-int main(int argc, char *argv[])
-{
-	// read the solution file
 	int ruleset;
 	int currentlevel;
 	int extrasize;
-	solutioninfo solution = {};
+	solutioninfo *solution = &self->solution;
 	gamesetup game;
-	fileinfo file;
+	outputinfo output;
+	recordinfo record, *rec;
+	long offset;
+	double recordstart;
+	unsigned long steadystart = 0;
 	int first;
+	int atend, damaged;
 	int skipfirstread;
-	int ok;
+	int ok, r;
 
 	unsigned char extra[256];
-	bstring movestr = NULL;
+	bstring movestr = self->movestr;
+	statsinfo *stats = self->stats;
+	compressjsonfunc compress;
 
-	clearfileinfo(&file);
-
-	if (argc < 2) {
-	    fprintf(stderr, "usage: tws2json file.tws\n");
-	    return 1;
-	}
-	if (!fileopen(&file, argv[1], "rb", "file error")) {
-		return 1;
-	}
-
-	if (!readsolutionheader(&file, &ruleset, &currentlevel, &extrasize, extra)) {
-		fileclose(&file, "error");
-		return 1;
+	if (!readsolutionheader(file, &ruleset, &currentlevel, &extrasize, extra)) {
+		return -1;
 	}
 
 	if (!(1 <= ruleset && ruleset <= 2)) {
 		errmsg("error", "Unknown ruleset (%d)\n", ruleset);
-		fileclose(&file, "error");
-		return 1;
+		return -1;
 	}
+	compress = compressjsonsolution_for(ruleset);
 
 	// there might be some additional metadata after the header
 	// in a solution record for level 0
 	memset(&game, 0, sizeof game);
-	ok = readsolution(&file, &game);
+	offset = file->fp ? ftell(file->fp) : -1;
+	recordstart = trace_now();
+	stats_begin(stats, Stage_Read);
+	atend = !file->fp || filetestend(file);
+	ok = readsolution(file, &game);
+	stats_end(stats, Stage_Read);
+	damaged = !ok && !atend;
 	skipfirstread = 0;
 	if (ok && game.number != 0) {
 		skipfirstread = 1;
 	}
 
-	// write json header
-	printf("{\"class\":\"tws\",\n");
-	printf(" \"ruleset\":\"%s\",\n", ruleset_names[ruleset]);
-	if (currentlevel != 0) {
-		printf(" \"currentlevel\":%d,\n", currentlevel);
-	}
-	if (game.sgflags & SGF_SETNAME) {
-		printf(" \"levelset\":\"%s\",\n", game.name);
-	}
-	printf(" \"generator\":\"tws2json/" VERSION "\",\n");
-	printf(" \"solutions\":[\n");
+	output_init(&output, out, self->format);
+	stats_begin(stats, Stage_Write);
+	output_begin(&output, ruleset, currentlevel,
+		     (game.sgflags & SGF_SETNAME) ? game.name : NULL);
+	stats_end(stats, Stage_Write);
 
-	movestr = bfromcstr("");
-	for (first = 1;; first = 0) {
+	for (first = 1; !damaged; first = 0) {
 		if (!(first && skipfirstread)) {
 			clearsolution(&game);
 			memset(&game, 0, sizeof game);
-			ok = readsolution(&file, &game);
+			// Everything after the first record should be
+			// converted without allocating.
+			if (stats && stats->records == 1 && !steadystart) {
+				steadystart = allocstats.allocs;
+			}
+			offset = file->fp ? ftell(file->fp) : -1;
+			recordstart = trace_now();
+			stats_begin(stats, Stage_Read);
+			atend = !file->fp || filetestend(file);
+			ok = readsolution(file, &game);
+			stats_end(stats, Stage_Read);
 			if (!ok) {
+				// A record that cannot be read before the end
+				// of the file is damaged.
+				damaged = !atend;
 				break;
 			}
 		}
+		if (stats && game.solutionsize) {
+			stats->records++;
+		}
 		if (game.number == 0) {
 			continue;
 		}
-		// Trailing commas are not allowed.
-		if (!first) {
-			printf(",\n");
-			fflush(stdout);
+		rec = NULL;
+		if (self->withrecords) {
+			record.offset = offset;
+			record.size = game.solutionsize;
+			record.hash = hash64(game.solutiondata, game.solutionsize);
+			rec = &record;
 		}
 		// write json level
-		if (game.solutionsize == 0) {
+		if (game.solutionsize <= 16) {
 			//just the number and password
-			printf("  {\"class\":\"solution\",\n"
-			       "   \"number\":%u,\n"
-			       "   \"password\":\"%.4s\"}",
-			       game.number,
-			       game.passwd);
+			stats_begin(stats, Stage_Write);
+			output_solution(&output, &game, rec, NULL, NULL);
+			stats_end(stats, Stage_Write);
+			trace_span("record", recordstart, NULL, game.number);
 		} else {
-			ok = expandsolution(&solution, &game);
+			stats_begin(stats, Stage_Decode);
+			ok = expandsolution(solution, &game);
+			stats_end(stats, Stage_Decode);
 			if (!ok) {
 				// TODO: print error message
 				continue;
 			}
-			if (compressjsonsolution(&solution.moves, game.besttime, movestr)) {
+			stats_begin(stats, Stage_Encode);
+			r = compress(&solution->moves, game.besttime, movestr);
+			stats_end(stats, Stage_Encode);
+			if (r) {
 				// TODO: print error message
 				continue;
 			}
-			printf("  {\"class\":\"solution\",\n"
-			       "   \"number\":%u,\n"
-			       "   \"password\":\"%s\",\n"
-			       "   \"rndslidedir\":%d,\n"
-			       "   \"stepping\":%d,\n"
-			       "   \"rndseed\":%lu,\n"
-			       "   \"moves\":\"%s\"}",
-			       game.number,
-			       game.passwd,
-			       (int)solution.rndslidedir,
-			       (int)solution.stepping,
-			       solution.rndseed,
-			       bdatae(movestr, "<out of memory>"));
+			if (stats) {
+				stats->moves += solution->moves.count;
+				stats->movestrbytes += blength(movestr);
+				countsolutionformats(&game, stats->formats);
+			}
+			stats_begin(stats, Stage_Write);
+			output_solution(&output, &game, rec, solution,
+					bdatae(movestr, "<out of memory>"));
+			stats_end(stats, Stage_Write);
+			trace_span("record", recordstart, NULL, game.number);
 		}
 	}
-	printf("\n]}\n");
-
 	clearsolution(&game);
-	destroymovelist(&solution.moves);
-	bdestroy(movestr);
-	fileclose(&file, "error");
+	if (stats && steadystart) {
+		stats->recordallocs += allocstats.allocs - steadystart;
+	}
 
+	if (stats && file->fp && (offset = ftell(file->fp)) > 0) {
+		stats->bytes += offset;
+	}
+	stats_begin(stats, Stage_Write);
+	r = output_end(&output);
+	stats_end(stats, Stage_Write);
+	if (r < 0 || damaged) {
+		return -1;
+	}
 	return 0;
 }
+
+/* Adapter between servesocket() and convertfile().
+ */
+static int serveconvert(fileinfo *file, FILE *out, void *data)
+{
+    return convertfile(data, file, out);
+}
+
+static void usage(FILE *fp)
+{
+    fprintf(fp, "usage: tws2json [format] file.tws\n"
+		"       tws2json [format] --serve socket [--workers n]\n"
+		"       tws2json --verify [--jobs n] file.tws...\n"
+		"       tws2json --repack file.tws...\n"
+		"       tws2json --merge out.tws file.tws...\n"
+		"       tws2json --diff old.tws new.tws\n"
+		"       tws2json --dedup table.tsv [--jobs n] file.tws|dir...\n"
+		"\n"
+		"formats:\n"
+		"  (default)   pretty-printed JSON\n"
+		"  --compact   JSON without insignificant whitespace\n"
+		"  --ndjson    newline-delimited JSON, one solution per line\n"
+		"  --columnar  binary columnar container\n"
+		"  --cbor      CBOR encoding of the JSON document\n"
+		"\n"
+		"  --record-info  add each record's offset, size and hash\n"
+		"  --stats        write counters and stage timings to stderr\n"
+		"  --trace file   record a Chrome trace of the conversion,\n"
+		"                 --verify or --dedup run in file\n"
+		"  --perf-counters  write hardware counters per stage to stderr\n"
+		"  --force-isa=isa  use the generic, sse2, sse4.2, avx2 or avx512\n"
+		"                 kernels instead of the best the CPU supports\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static struct option const longopts[] = {
+		{ "serve",	required_argument,	NULL, 's' },
+		{ "workers",	required_argument,	NULL, 'w' },
+		{ "verify",	no_argument,		NULL, 'v' },
+		{ "jobs",	required_argument,	NULL, 'j' },
+		{ "repack",	no_argument,		NULL, 'p' },
+		{ "merge",	required_argument,	NULL, 'm' },
+		{ "diff",	no_argument,		NULL, 'd' },
+		{ "dedup",	required_argument,	NULL, 'D' },
+		{ "ndjson",	no_argument,		NULL, 'n' },
+		{ "compact",	no_argument,		NULL, 'c' },
+		{ "columnar",	no_argument,		NULL, 'C' },
+		{ "cbor",	no_argument,		NULL, 'B' },
+		{ "record-info", no_argument,		NULL, 'r' },
+		{ "stats",	no_argument,		NULL, 'S' },
+		{ "trace",	required_argument,	NULL, 'T' },
+		{ "perf-counters", no_argument,		NULL, 'P' },
+		{ "force-isa",	required_argument,	NULL, 'I' },
+		{ "help",	no_argument,		NULL, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+	convertinfo convert;
+	fileinfo file;
+	char const *socketpath = NULL;
+	int workers = 0;
+	int format = Output_JSON;
+	int withrecords = 0;
+	int withstats = 0;
+	char const *tracepath = NULL;
+	int withperf = 0;
+	double start;
+	statsinfo stats;
+	int verify = 0;
+	int repack = 0;
+	char const *mergepath = NULL;
+	int diff = 0;
+	char const *deduppath = NULL;
+	int jobs = 0;
+	int ch, r;
+
+	isa_init();
+	while ((ch = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+		switch (ch) {
+		case 's':
+			socketpath = optarg;
+			break;
+		case 'w':
+			workers = atoi(optarg);
+			break;
+		case 'v':
+			verify = 1;
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			break;
+		case 'p':
+			repack = 1;
+			break;
+		case 'm':
+			mergepath = optarg;
+			break;
+		case 'd':
+			diff = 1;
+			break;
+		case 'D':
+			deduppath = optarg;
+			break;
+		case 'n':
+			format = Output_NDJSON;
+			break;
+		case 'c':
+			format = Output_CompactJSON;
+			break;
+		case 'C':
+			format = Output_Columnar;
+			break;
+		case 'B':
+			format = Output_CBOR;
+			break;
+		case 'r':
+			withrecords = 1;
+			break;
+		case 'S':
+			withstats = 1;
+			break;
+		case 'T':
+			tracepath = optarg;
+			break;
+		case 'P':
+			withperf = 1;
+			break;
+		case 'I':
+			if (isa_force(optarg) < 0) {
+				return 1;
+			}
+			break;
+		case 'h':
+			usage(stdout);
+			return 0;
+		default:
+			usage(stderr);
+			return 1;
+		}
+	}
+
+	if (tracepath) {
+		if (trace_open(tracepath) < 0) {
+			return 1;
+		}
+		atexit(trace_close);
+	}
+
+	if (verify) {
+		if (optind >= argc) {
+			usage(stderr);
+			return 1;
+		}
+		return verifyfiles(argv + optind, argc - optind, jobs) ? 1 : 0;
+	}
+
+	if (diff) {
+		if (argc - optind != 2) {
+			usage(stderr);
+			return 2;
+		}
+		r = difffiles(argv[optind], argv[optind + 1], stdout);
+		return r < 0 ? 2 : r;
+	}
+
+	if (deduppath) {
+		if (optind >= argc) {
+			usage(stderr);
+			return 1;
+		}
+		r = dedupfiles(deduppath, argv + optind, argc - optind, jobs);
+		return r < 0 ? 1 : 0;
+	}
+
+	if (mergepath) {
+		if (optind >= argc) {
+			usage(stderr);
+			return 1;
+		}
+		r = mergefiles(mergepath, argv + optind, argc - optind);
+		return r < 0 ? 1 : 0;
+	}
+
+	if (repack) {
+		if (optind >= argc) {
+			usage(stderr);
+			return 1;
+		}
+		for (r = 0; optind < argc; optind++) {
+			if (repackfile(argv[optind]) < 0) {
+				r = 1;
+			}
+		}
+		return r;
+	}
+
+	if (convert_init(&convert) < 0) {
+		memerrexit();
+	}
+	convert.format = format;
+	convert.withrecords = withrecords;
+
+	if (socketpath) {
+		r = servesocket(socketpath, workers, serveconvert, &convert);
+		convert_free(&convert);
+		return r < 0 ? 1 : 0;
+	}
+
+	if (optind >= argc) {
+		usage(stderr);
+		return 1;
+	}
+
+	// read the solution file
+	clearfileinfo(&file);
+	if (!fileopen(&file, argv[optind], "rb", "file error")) {
+		return 1;
+	}
+	// The stage timers also record the stages in a trace, and read
+	// the hardware counters.
+	if (withperf && perf_open() < 0) {
+		withperf = 0;
+	}
+	if (withstats || tracing || withperf) {
+		stats_init(&stats);
+		convert.stats = &stats;
+	}
+	start = trace_now();
+	r = convertfile(&convert, &file, stdout);
+	trace_span("file", start, argv[optind], 0);
+	convert_free(&convert);
+	fileclose(&file, "error");
+	if (withstats) {
+		stats_print(&stats, stderr);
+	}
+	perf_close(stderr);
+
+	return r < 0 ? 1 : 0;
+}
@@ -0,0 +1,474 @@
+/* twsbench.c: Measure the throughput of each stage of the converter.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "bstrlib.h"
+
+#include "solution.h"
+#include "jsoncompress.h"
+#include "fileio.h"
+#include "output.h"
+#include "err.h"
+
+/* One file's records, read once up front and kept in memory so that
+ * every stage after the first can be run on its own.
+ */
+typedef struct corpus {
+    char const	       *name;
+    unsigned char      *data;		/* the whole TWS file */
+    long		size;		/* its size in bytes */
+    int			ruleset;
+    int			allocated;	/* number of games allocated */
+    int			count;		/* number of solved levels */
+    gamesetup	       *games;		/* their records */
+    solutioninfo       *solutions;	/* their expanded moves */
+    bstring	       *movestrs;	/* their movestrings */
+    solutionbuf		packed;		/* reused by contractsolutionbuf() */
+    long		moves;		/* total number of moves */
+} corpus;
+
+/* The result of timing one stage.
+ */
+typedef struct stageinfo {
+    char const	       *stage;
+    int			iterations;	/* runs, over all samples */
+    double		median;		/* seconds per run, median sample */
+    double		relative;	/* speed relative to runreference() */
+    long		peakrss;	/* KiB, in the process of this stage */
+} stageinfo;
+
+/* Read the CPU time of the process. Unlike the wall clock, it does
+ * not count the time spent waiting for a CPU on a busy or virtual
+ * machine, which otherwise shifts every stage from one run to the
+ * next.
+ */
+static double now(void)
+{
+    struct timespec	ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Open the in-memory copy of a file as a fileinfo.
+ */
+static int openmem(corpus *c, fileinfo *file)
+{
+    clearfileinfo(file);
+    file->name = (char*)c->name;
+    file->fp = fmemopen(c->data, c->size, "rb");
+    if (!file->fp)
+	return fileerr(file, "fmemopen failed");
+    return TRUE;
+}
+
+/* Stage 1: parse every record in the file.
+ */
+static int runread(corpus *c)
+{
+    fileinfo		file;
+    gamesetup		game;
+    unsigned char	extra[256];
+    int			ruleset, level, extrasize;
+
+    if (!openmem(c, &file))
+	return FALSE;
+    if (!readsolutionheader(&file, &ruleset, &level, &extrasize, extra)) {
+	fclose(file.fp);
+	return FALSE;
+    }
+    memset(&game, 0, sizeof game);
+    while (!filetestend(&file) && readsolution(&file, &game))
+	clearsolution(&game);
+    clearsolution(&game);
+    fclose(file.fp);
+    return TRUE;
+}
+
+/* Stage 2: expand every solution into its moves.
+ */
+static int runexpand(corpus *c)
+{
+    int	i;
+
+    for (i = 0 ; i < c->count ; ++i)
+	if (!expandsolution(&c->solutions[i], &c->games[i]))
+	    return FALSE;
+    return TRUE;
+}
+
+/* Stage 3: turn every list of moves into a movestring, with the
+ * encoder specialized for the file's ruleset, as tws2json does.
+ */
+static int runcompress(corpus *c)
+{
+    compressjsonfunc	compress = compressjsonsolution_for(c->ruleset);
+    int			i;
+
+    for (i = 0 ; i < c->count ; ++i)
+	if ((*compress)(&c->solutions[i].moves, c->games[i].besttime,
+			c->movestrs[i]))
+	    return FALSE;
+    return TRUE;
+}
+
+/* Stage 3 again with the generic encoder, for comparison.
+ */
+static int runcompressgeneric(corpus *c)
+{
+    int	i;
+
+    for (i = 0 ; i < c->count ; ++i)
+	if (compressjsonsolution(&c->solutions[i].moves,
+				 c->games[i].besttime, c->movestrs[i]))
+	    return FALSE;
+    return TRUE;
+}
+
+/* Re-encode every expanded solution into one reused buffer, as
+ * json2tws does.
+ */
+static int runcontractbuf(corpus *c)
+{
+    int	i;
+
+    for (i = 0 ; i < c->count ; ++i)
+	if (!contractsolutionbuf(&c->solutions[i], &c->games[i], &c->packed))
+	    return FALSE;
+    return TRUE;
+}
+
+/* Re-encode every expanded solution with contractsolution(), which
+ * allocates the data of each record, as twsgen and --verify do. A
+ * scratch record is used so that the corpus is left as it was read.
+ */
+static int runcontract(corpus *c)
+{
+    gamesetup	game;
+    int		i;
+
+    for (i = 0 ; i < c->count ; ++i) {
+	game = c->games[i];
+	game.solutiondata = NULL;
+	game.solutionsize = 0;
+	if (!contractsolution(&c->solutions[i], &game))
+	    return FALSE;
+	clearsolution(&game);
+    }
+    return TRUE;
+}
+
+/* Stage 4: write the JSON document, discarding it.
+ */
+static int runemit(corpus *c)
+{
+    static FILE	       *null;
+    outputinfo		output;
+    int			i;
+
+    if (!null && !(null = fopen("/dev/null", "w")))
+	return FALSE;
+    output_init(&output, null, Output_JSON);
+    output_begin(&output, c->ruleset, 0, NULL);
+    for (i = 0 ; i < c->count ; ++i)
+	output_solution(&output, &c->games[i], NULL, &c->solutions[i],
+			bdatae(c->movestrs[i], ""));
+    return output_end(&output) == 0;
+}
+
+/* The reference kernel: an FNV-1a hash of the whole file, which uses
+ * none of the converter's code. Each stage is timed against it in the
+ * same process, so that the ratio of the two cancels out how fast the
+ * machine happens to be running, and can be compared between runs.
+ */
+static volatile unsigned long	referencehash;
+
+static int runreference(corpus *c)
+{
+    unsigned long	h = 2166136261UL;
+    long		i;
+
+    for (i = 0 ; i < c->size ; ++i)
+	h = ((h ^ c->data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    referencehash = h;
+    return TRUE;
+}
+
+/* Load a file and prepare the input of every stage.
+ */
+static int loadcorpus(corpus *c, char const *name)
+{
+    fileinfo		file;
+    gamesetup		game;
+    unsigned char	extra[256];
+    int			level, extrasize, i;
+
+    memset(c, 0, sizeof *c);
+    c->name = name;
+    clearfileinfo(&file);
+    if (!fileopen(&file, name, "rb", "file error"))
+	return FALSE;
+    if (fseek(file.fp, 0, SEEK_END) || (c->size = ftell(file.fp)) < 0
+				    || fseek(file.fp, 0, SEEK_SET)) {
+	fileerr(&file, "cannot determine file size");
+	fileclose(&file, NULL);
+	return FALSE;
+    }
+    c->data = filereadbuf(&file, c->size, "unexpected EOF");
+    fileclose(&file, NULL);
+    if (!c->data)
+	return FALSE;
+
+    if (!openmem(c, &file))
+	return FALSE;
+    if (!readsolutionheader(&file, &c->ruleset, &level, &extrasize, extra)) {
+	fclose(file.fp);
+	return FALSE;
+    }
+    memset(&game, 0, sizeof game);
+    while (!filetestend(&file) && readsolution(&file, &game)) {
+	if (game.number && game.solutionsize > 16) {
+	    if (c->count == c->allocated) {
+		c->allocated = c->allocated ? c->allocated * 2 : 256;
+		xalloc(c->games, c->allocated * sizeof *c->games);
+	    }
+	    c->games[c->count++] = game;
+	    game.solutiondata = NULL;
+	}
+	clearsolution(&game);
+    }
+    fclose(file.fp);
+
+    c->solutions = calloc(c->count, sizeof *c->solutions);
+    c->movestrs = calloc(c->count, sizeof *c->movestrs);
+    if (c->count && (!c->solutions || !c->movestrs))
+	memerrexit();
+    for (i = 0 ; i < c->count ; ++i)
+	if (!(c->movestrs[i] = bfromcstr("")))
+	    memerrexit();
+    if (!runexpand(c) || !runcompress(c)) {
+	errmsg(name, "invalid solution data");
+	return FALSE;
+    }
+    for (i = 0 ; i < c->count ; ++i)
+	c->moves += c->solutions[i].moves.count;
+    return TRUE;
+}
+
+static void freecorpus(corpus *c)
+{
+    int	i;
+
+    for (i = 0 ; i < c->count ; ++i) {
+	clearsolution(&c->games[i]);
+	destroymovelist(&c->solutions[i].moves);
+	bdestroy(c->movestrs[i]);
+    }
+    free(c->games);
+    free(c->solutions);
+    free(c->movestrs);
+    free(c->packed.data);
+    free(c->data);
+}
+
+/* Each timing sample repeats a stage until it has run for at least
+ * SAMPLETIME seconds, so that short stages are not timed on a single
+ * run. At least MINSAMPLES samples are taken, and at most MAXSAMPLES.
+ */
+#define SAMPLETIME	0.02
+#define MINSAMPLES	9
+#define MAXSAMPLES	1000
+
+static int cmpdouble(void const *a, void const *b)
+{
+    double	x = *(double const*)a, y = *(double const*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* Return the median of n samples, sorting them.
+ */
+static double median(double *samples, int n)
+{
+    qsort(samples, n, sizeof *samples, cmpdouble);
+    return n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+}
+
+/* Take one sample: run a stage repeatedly for at least mintime
+ * seconds, and store the time per run and the time taken.
+ */
+static int timesample(int (*run)(corpus*), corpus *c, double mintime,
+		      double *per, double *total, int *reps)
+{
+    double	t0, t;
+
+    *reps = 0;
+    t0 = now();
+    do {
+	if (!(*run)(c))
+	    return FALSE;
+	++*reps;
+    } while ((t = now() - t0) < mintime);
+    *per = t / *reps;
+    *total = t;
+    return TRUE;
+}
+
+/* Time a stage in samples for at least mintime seconds, and keep the
+ * median time per run, which one disturbed or unusually quick sample
+ * cannot move. Each sample of the stage is followed by one of the
+ * reference kernel lasting as long, and the median ratio of the two
+ * is kept as the stage's relative speed.
+ */
+static int timestage(stageinfo *st, char const *stage,
+		     int (*run)(corpus*), corpus *c, double mintime)
+{
+    double	samples[MAXSAMPLES], ratios[MAXSAMPLES];
+    double	start, per, refper, total;
+    int		n = 0, reps;
+
+    st->stage = stage;
+    st->iterations = 0;
+    start = now();
+    do {
+	if (!timesample(run, c, SAMPLETIME, &per, &total, &reps))
+	    return FALSE;
+	st->iterations += reps;
+	if (!timesample(runreference, c, total, &refper, &total, &reps))
+	    return FALSE;
+	samples[n] = per;
+	ratios[n] = refper / per;
+	++n;
+    } while (n < MAXSAMPLES && (n < MINSAMPLES || now() - start < mintime));
+    st->median = median(samples, n);
+    st->relative = median(ratios, n);
+    return TRUE;
+}
+
+/* Return the peak resident set size of the process so far, in KiB.
+ * A forked process starts from the size of its parent at the fork.
+ */
+static long peakrss(void)
+{
+    struct rusage	ru;
+
+    if (getrusage(RUSAGE_SELF, &ru))
+	return -1;
+    return ru.ru_maxrss;
+}
+
+/* Write one result as a line of JSON.
+ */
+static void report(corpus const *c, stageinfo const *st)
+{
+    double	t = st->median > 0 ? st->median : 1e-9;
+
+    printf("{\"file\":\"%s\",\"stage\":\"%s\",\"iterations\":%d,"
+	   "\"seconds\":%.9f,\"bytes\":%ld,\"solutions\":%d,\"moves\":%ld,"
+	   "\"mb_per_s\":%.3f,\"solutions_per_s\":%.1f,"
+	   "\"relative_speed\":%.6f,\"peak_rss_kb\":%ld}\n",
+	   c->name, st->stage, st->iterations, st->median, c->size, c->count,
+	   c->moves, c->size / t / 1e6, c->count / t, st->relative,
+	   st->peakrss);
+}
+
+/* Time and report one stage in a process of its own, so that its peak
+ * RSS is that of the loaded corpus plus what this stage alone uses,
+ * and not the highest of every stage run before it.
+ */
+static int benchstage(corpus *c, char const *stage, int (*run)(corpus*),
+		      double mintime)
+{
+    stageinfo	st;
+    pid_t	pid;
+    int		status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+	errmsg("fork", "cannot start process");
+	return FALSE;
+    }
+    if (pid == 0) {
+	if (!timestage(&st, stage, run, c, mintime))
+	    _exit(1);
+	st.peakrss = peakrss();
+	report(c, &st);
+	fflush(stdout);
+	_exit(0);
+    }
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)
+				      || WEXITSTATUS(status) != 0)
+	return FALSE;
+    return TRUE;
+}
+
+static void usage(FILE *fp)
+{
+    fprintf(fp, "usage: twsbench [-t seconds] file.tws...\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static struct {
+		char const *name;
+		int (*run)(corpus*);
+	} const stages[] = {
+		{ "readsolution", runread },
+		{ "expandsolution", runexpand },
+		{ "compressjsonsolution", runcompress },
+		{ "compressjsonsolution_generic", runcompressgeneric },
+		{ "emit", runemit },
+		{ "contractsolutionbuf", runcontractbuf },
+		{ "contractsolution", runcontract },
+	};
+	corpus c;
+	double mintime = 0.5;
+	int ch, i, s, r = 0;
+
+	while ((ch = getopt(argc, argv, "t:h")) != -1) {
+		switch (ch) {
+		case 't':
+			mintime = atof(optarg);
+			break;
+		case 'h':
+			usage(stdout);
+			return 0;
+		default:
+			usage(stderr);
+			return 1;
+		}
+	}
+	if (optind >= argc) {
+		usage(stderr);
+		return 1;
+	}
+
+	for (i = optind; i < argc; i++) {
+		if (!loadcorpus(&c, argv[i])) {
+			freecorpus(&c);
+			r = 1;
+			continue;
+		}
+		for (s = 0; s < (int)(sizeof stages / sizeof *stages); s++) {
+			if (!benchstage(&c, stages[s].name, stages[s].run,
+					mintime)) {
+				errmsg(argv[i], "%s failed", stages[s].name);
+				r = 1;
+				break;
+			}
+		}
+		freecorpus(&c);
+	}
+	return r;
+}
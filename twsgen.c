@@ -0,0 +1,243 @@
+/* twsgen.c: Generate synthetic Tile World solution files.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "solution.h"
+#include "fileio.h"
+#include "err.h"
+
+/* The size of the output buffer.
+ */
+#define OUTBUFSIZE (64 * 1024)
+
+/* The state of the generator. The pseudorandom sequence is xorshift64*,
+ * so that a given seed produces the same file on every platform.
+ */
+typedef struct geninfo {
+    uint64_t		state;		/* the PRNG state, never zero */
+    int			ruleset;	/* Ruleset_Lynx or Ruleset_MS */
+    int			maxmoves;	/* upper bound on moves per level */
+    solutioninfo	solution;	/* reused for every level */
+    gamesetup		game;		/* reused for every level */
+} geninfo;
+
+static uint32_t rnd(geninfo *self)
+{
+    self->state ^= self->state >> 12;
+    self->state ^= self->state << 25;
+    self->state ^= self->state >> 27;
+    return (self->state * UINT64_C(2685821657736338717)) >> 32;
+}
+
+/* Return a random number from 0 to n - 1.
+ */
+static uint32_t rndrange(geninfo *self, uint32_t n)
+{
+    return (uint32_t)(((uint64_t)rnd(self) * n) >> 32);
+}
+
+static int const orthogonal[4] = { NORTH, WEST, SOUTH, EAST };
+static int const diagonal[4] = {
+    NORTH | WEST, SOUTH | WEST, SOUTH | EAST, NORTH | EAST
+};
+
+/* Append a move after delta idle ticks, unless it would run past the
+ * end of the game timer. FALSE is returned if the move did not fit.
+ */
+static int addmove(geninfo *self, long *when, unsigned long delta, int dir)
+{
+    action	act;
+
+    if (*when + 1 + (long)delta > MAXIMUM_TICK_COUNT)
+	return FALSE;
+    *when += 1 + delta;
+    act.when = *when;
+    act.dir = dir;
+    addtomovelist(&self->solution.moves, act);
+    return TRUE;
+}
+
+/* Generate the moves of one solution. The moves come in runs, chosen
+ * so that every one of the four byte formats is exercised: walks of
+ * moves four ticks apart (format #3), quick moves (format #1), moves
+ * after a pause (format #2), and diagonal moves in Lynx or mouse
+ * moves in MS (format #4). The length of each solution is drawn from
+ * a roughly log-uniform distribution, so that most are short but a
+ * few are very long.
+ */
+static void genmoves(geninfo *self)
+{
+    actlist    *moves = &self->solution.moves;
+    long	when = -1;
+    int		count, bits, kind, run, i;
+    int		dir = 0;
+    int		fits = TRUE;
+
+    for (bits = 0 ; (1 << bits) < self->maxmoves ; ++bits) ;
+    count = 1 + rndrange(self, 1 << rndrange(self, bits + 1));
+    if (count > self->maxmoves)
+	count = self->maxmoves;
+
+    initmovelist(moves);
+    while (fits && moves->count < count) {
+	kind = rndrange(self, 16);
+	run = 1 + rndrange(self, 12);
+	for (i = 0 ; fits && i < run && moves->count < count ; ++i) {
+	    if (kind < 7) {
+		if (i == 0 || rndrange(self, 4) == 0)
+		    dir = orthogonal[rndrange(self, 4)];
+		fits = addmove(self, &when, 3, dir);
+	    } else if (kind < 11) {
+		fits = addmove(self, &when, rndrange(self, 8),
+			       orthogonal[rndrange(self, 4)]);
+	    } else if (kind < 13) {
+		fits = addmove(self, &when, 8 + rndrange(self, 2040),
+			       orthogonal[rndrange(self, 4)]);
+	    } else if (kind < 14) {
+		fits = addmove(self, &when, 2048 + rndrange(self, 1 << 18),
+			       orthogonal[rndrange(self, 4)]);
+		run = 1;
+	    } else if (self->ruleset == Ruleset_Lynx) {
+		fits = addmove(self, &when, rndrange(self, 8),
+			       diagonal[rndrange(self, 4)]);
+	    } else {
+		fits = addmove(self, &when, rndrange(self, 8),
+			       mousemovecmd((int)rndrange(self, MOUSERANGE)
+						+ MOUSERANGEMIN,
+					    (int)rndrange(self, MOUSERANGE)
+						+ MOUSERANGEMIN));
+	    }
+	}
+    }
+}
+
+/* Generate and write the record of one level. One level in sixteen is
+ * left unsolved, with only its password recorded.
+ */
+static int genlevel(geninfo *self, fileinfo *out, int number)
+{
+    gamesetup  *game = &self->game;
+    solutioninfo *solution = &self->solution;
+    unsigned char passwd[6];
+    int		i;
+
+    game->number = number;
+    for (i = 0 ; i < 4 ; ++i)
+	game->passwd[i] = 'A' + rndrange(self, 26);
+    game->passwd[4] = '\0';
+
+    if (rndrange(self, 16) == 0) {
+	passwd[0] = number & 0xFF;
+	passwd[1] = (number >> 8) & 0xFF;
+	memcpy(passwd + 2, game->passwd, 4);
+	return filewriteint32(out, sizeof passwd, "write error")
+	    && filewrite(out, passwd, sizeof passwd, "write error");
+    }
+
+    solution->rndseed = rnd(self) & 0x7FFFFFFF;
+    solution->rndslidedir = orthogonal[rndrange(self, 4)];
+    solution->stepping = rndrange(self, 8);
+    solution->flags = 0;
+    genmoves(self);
+    game->besttime = solution->moves.list[solution->moves.count - 1].when;
+
+    if (!contractsolution(solution, game))
+	return FALSE;
+    return writesolution(out, game);
+}
+
+static void usage(FILE *fp)
+{
+    fprintf(fp, "usage: twsgen [-r lynx|ms] [-n levels] [-m maxmoves]"
+		" [-s seed] [file.tws]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	geninfo self;
+	fileinfo out;
+	char setname[64];
+	unsigned long seed = 1;
+	int levels = 100;
+	int ch, i, ok;
+
+	memset(&self, 0, sizeof self);
+	self.ruleset = Ruleset_MS;
+	self.maxmoves = 10000;
+
+	while ((ch = getopt(argc, argv, "r:n:m:s:h")) != -1) {
+		switch (ch) {
+		case 'r':
+			if (!strcmp(optarg, "lynx")) {
+				self.ruleset = Ruleset_Lynx;
+			} else if (!strcmp(optarg, "ms")) {
+				self.ruleset = Ruleset_MS;
+			} else {
+				usage(stderr);
+				return 1;
+			}
+			break;
+		case 'n':
+			levels = atoi(optarg);
+			break;
+		case 'm':
+			self.maxmoves = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+		case 'h':
+			usage(stdout);
+			return 0;
+		default:
+			usage(stderr);
+			return 1;
+		}
+	}
+	if (argc - optind > 1 || levels < 1 || levels > 0xFFFF
+			      || self.maxmoves < 1) {
+		usage(stderr);
+		return 1;
+	}
+
+	// The state must never be zero; mix the seed so that nearby
+	// seeds give unrelated files.
+	self.state = (seed + 1) * UINT64_C(0x9E3779B97F4A7C15);
+
+	clearfileinfo(&out);
+	if (optind < argc) {
+		if (!fileopen(&out, argv[optind], "wb", "file error")) {
+			return 1;
+		}
+	} else {
+		out.name = "stdout";
+		out.fp = stdout;
+	}
+	setvbuf(out.fp, NULL, _IOFBF, OUTBUFSIZE);
+
+	sprintf(setname, "synthetic-%lu.dac", seed);
+	ok = writesolutionheader(&out, self.ruleset, 1, 0, NULL)
+	  && writesolutionsetname(&out, setname);
+	for (i = 1; ok && i <= levels; i++) {
+		ok = genlevel(&self, &out, i);
+	}
+
+	clearsolution(&self.game);
+	destroymovelist(&self.solution.moves);
+	if (fflush(out.fp) != 0) {
+		ok = fileerr(&out, "write error");
+	}
+	if (optind < argc) {
+		fileclose(&out, "error");
+	}
+
+	return ok ? 0 : 1;
+}
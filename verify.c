@@ -0,0 +1,224 @@
+/* verify.c: Checking that solutions survive conversion to JSON.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<unistd.h>
+#include	<sys/types.h>
+#include	<sys/wait.h>
+#include	"bstrlib.h"
+#include	"err.h"
+#include	"fileio.h"
+#include	"solution.h"
+#include	"jsoncompress.h"
+#include	"movestr.h"
+#include	"trace.h"
+#include	"verify.h"
+
+/* Compare two move lists, describing the first difference on out.
+ * FALSE is returned if they differ.
+ */
+static int comparemoves(actlist const *orig, actlist const *copy,
+			char const *filename, int number, FILE *out)
+{
+    int	i, n;
+
+    n = orig->count < copy->count ? orig->count : copy->count;
+    for (i = 0 ; i < n ; ++i) {
+	if (orig->list[i].when != copy->list[i].when
+			|| orig->list[i].dir != copy->list[i].dir) {
+	    fprintf(out, "%s: level %d: move %d is %d at tick %u,"
+			 " but came back as %d at tick %u\n",
+		    filename, number, i,
+		    orig->list[i].dir, (unsigned)orig->list[i].when,
+		    copy->list[i].dir, (unsigned)copy->list[i].when);
+	    return FALSE;
+	}
+    }
+    if (orig->count != copy->count) {
+	fprintf(out, "%s: level %d: %d moves came back as %d\n",
+		filename, number, orig->count, copy->count);
+	return FALSE;
+    }
+    return TRUE;
+}
+
+/* Verify one solution. FALSE is returned if it did not survive.
+ */
+static int verifysolution(gamesetup *game, solutioninfo *orig,
+			  solutioninfo *copy, bstring movestr,
+			  compressjsonfunc compress,
+			  char const *filename, FILE *out)
+{
+    gamesetup		recoded;
+    unsigned long	solutiontime;
+    int			ok;
+
+    if (!expandsolution(orig, game)) {
+	fprintf(out, "%s: level %d: invalid solution data\n",
+		filename, game->number);
+	return FALSE;
+    }
+    if (compress(&orig->moves, game->besttime, movestr) < 0) {
+	fprintf(out, "%s: level %d: cannot be written as a movestring\n",
+		filename, game->number);
+	return FALSE;
+    }
+    if (!parsemovestring(bdata(movestr), &copy->moves, &solutiontime)) {
+	fprintf(out, "%s: level %d: movestring does not parse\n",
+		filename, game->number);
+	return FALSE;
+    }
+
+    copy->flags = orig->flags;
+    copy->rndseed = orig->rndseed;
+    copy->rndslidedir = orig->rndslidedir;
+    copy->stepping = orig->stepping;
+    memset(&recoded, 0, sizeof recoded);
+    recoded.number = game->number;
+    memcpy(recoded.passwd, game->passwd, sizeof recoded.passwd);
+    recoded.besttime = solutiontime;
+    if (!contractsolution(copy, &recoded) || !expandsolution(copy, &recoded)) {
+	fprintf(out, "%s: level %d: cannot be packed again\n",
+		filename, game->number);
+	clearsolution(&recoded);
+	return FALSE;
+    }
+
+    ok = comparemoves(&orig->moves, &copy->moves, filename, game->number, out);
+    if (ok && recoded.besttime != game->besttime) {
+	fprintf(out, "%s: level %d: solution time %d came back as %d\n",
+		filename, game->number, game->besttime, recoded.besttime);
+	ok = FALSE;
+    }
+    clearsolution(&recoded);
+    return ok;
+}
+
+/* Verify every solution in an open TWS file.
+ */
+int verifyfile(fileinfo *file, FILE *out)
+{
+    solutioninfo	orig, copy;
+    gamesetup		game;
+    bstring		movestr;
+    compressjsonfunc	compress;
+    unsigned char	extra[256];
+    int			ruleset, currentlevel, extrasize;
+    int			total = 0, bad = 0;
+    int			readerr = FALSE;
+
+    if (!readsolutionheader(file, &ruleset, &currentlevel, &extrasize, extra))
+	return -1;
+    /* Check the encoder that the conversion itself would use.
+     */
+    compress = compressjsonsolution_for(ruleset);
+
+    memset(&orig, 0, sizeof orig);
+    memset(&copy, 0, sizeof copy);
+    memset(&game, 0, sizeof game);
+    movestr = bfromcstr("");
+    if (!movestr)
+	memerrexit();
+
+    while (!filetestend(file)) {
+	/* A record that cannot be read before the end of the file
+	 * means the file is damaged, which must not pass.
+	 */
+	if (!readsolution(file, &game)) {
+	    readerr = TRUE;
+	    break;
+	}
+	if (game.number != 0 && game.solutionsize > 16) {
+	    ++total;
+	    if (!verifysolution(&game, &orig, &copy, movestr, compress,
+				file->name, out))
+		++bad;
+	}
+	clearsolution(&game);
+    }
+    clearsolution(&game);
+
+    fprintf(out, "%s: %d solutions verified, %d mismatched%s\n",
+	    file->name, total, bad, readerr ? ", file damaged" : "");
+
+    bdestroy(movestr);
+    destroymovelist(&orig.moves);
+    destroymovelist(&copy.moves);
+    return readerr ? -1 : bad;
+}
+
+/* Verify the files whose index is congruent to first, modulo step.
+ * Each file's report is written in one piece so that the reports of
+ * concurrent workers do not interleave.
+ */
+static int verifyshare(char **names, int count, int first, int step)
+{
+    fileinfo	file;
+    FILE       *report;
+    char       *text;
+    size_t	size;
+    double	start;
+    int		i, r, failed = 0;
+
+    for (i = first ; i < count ; i += step) {
+	start = trace_now();
+	clearfileinfo(&file);
+	if (!fileopen(&file, names[i], "rb", "file error")) {
+	    failed = 1;
+	    continue;
+	}
+	text = NULL;
+	report = open_memstream(&text, &size);
+	if (!report)
+	    memerrexit();
+	r = verifyfile(&file, report);
+	fclose(report);
+	fwrite(text, 1, size, stdout);
+	fflush(stdout);
+	free(text);
+	fileclose(&file, "error");
+	trace_span("file", start, names[i], 0);
+	if (r != 0)
+	    failed = 1;
+    }
+    return failed;
+}
+
+/* Verify a list of files, using up to jobs processes at once.
+ */
+int verifyfiles(char **names, int count, int jobs)
+{
+    pid_t	pid;
+    int		status, i, failed = 0;
+
+    if (jobs <= 0)
+	jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs > count)
+	jobs = count;
+    if (jobs <= 1)
+	return verifyshare(names, count, 0, 1);
+
+    fflush(NULL);
+    trace_flush();
+    for (i = 0 ; i < jobs ; ++i) {
+	pid = fork();
+	if (pid < 0) {
+	    warn("fork: %s", strerror(errno));
+	    failed |= verifyshare(names, count, i, jobs);
+	} else if (pid == 0) {
+	    failed = verifyshare(names, count, i, jobs);
+	    trace_flush();
+	    _exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+    }
+    while (wait(&status) > 0)
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	    failed = 1;
+    return failed;
+}
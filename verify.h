@@ -0,0 +1,27 @@
+/* verify.h: Checking that solutions survive conversion to JSON.
+ *
+ * Copyright © 2026 by the tws2json contributors, under the GNU
+ * General Public License. No warranty. See COPYING for details.
+ */
+
+#ifndef	_verify_h_
+#define	_verify_h_
+
+#include	<stdio.h>
+#include	"fileio.h"
+
+/* Run every solution in an open TWS file through the movestring
+ * encoder, the movestring parser and contractsolution(), expand the
+ * result again, and compare it with the original. Each mismatch is
+ * described on out, followed by a summary line. The return value is
+ * the number of mismatched solutions, or -1 if the file could not be
+ * read to the end.
+ */
+extern int verifyfile(fileinfo *file, FILE *out);
+
+/* Verify a list of files, using up to jobs processes at once. The
+ * return value is zero if every file verified cleanly.
+ */
+extern int verifyfiles(char **names, int count, int jobs);
+
+#endif